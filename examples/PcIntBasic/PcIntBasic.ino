@@ -0,0 +1,36 @@
+/*
+ * PcIntBasic
+ *
+ * Count the falling edges on pin A0, e.g. from a rain gauge reed switch.
+ */
+
+#include <Sodaq_PcInt.h>
+
+static volatile uint8_t rain1ticks;
+
+void handleA0()
+{
+  static bool rain1State;
+  //rain counter 1
+  if (digitalRead(A0) == LOW) {
+    if (!rain1State) {
+      rain1ticks++;
+      rain1State = true;
+    }
+  } else {
+    rain1State = false;
+  }
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  pinMode(A0, INPUT_PULLUP);
+  PcInt::attachInterrupt(A0, handleA0);
+}
+
+void loop()
+{
+  Serial.println(rain1ticks);
+  delay(1000);
+}
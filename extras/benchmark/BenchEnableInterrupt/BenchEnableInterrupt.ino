@@ -0,0 +1,102 @@
+/*
+ * BenchEnableInterrupt
+ *
+ * Pin change benchmark, the EnableInterrupt library.
+ * Run it in simavr (atmega328p, 16 MHz) with extras/benchmark/run_bench.py.
+ *
+ * Pin 8 (PB0, PCINT0) is an output, writing PINB toggles it and the pin
+ * change interrupt fires for outputs too.  Timer1 runs at the CPU clock.
+ *
+ *   latency  cycles from the toggle to the first instruction of the
+ *            handler (min and max over all edges)
+ *   cycles   extra cycles per edge with the interrupt enabled, i.e. the
+ *            complete ISR including the (empty) handler
+ */
+
+#include <EnableInterrupt.h>
+
+#define EDGES   100
+
+static volatile uint16_t entry;
+
+static void handler()
+{
+  entry = TCNT1;
+}
+
+static void setupPcint()
+{
+  enableInterrupt(8, handler, CHANGE);
+}
+
+static void enablePcint(bool on)
+{
+  if (on) {
+    enableInterrupt(8, handler, CHANGE);
+  } else {
+    disableInterrupt(8);
+  }
+}
+
+/*
+ * Toggle the pin EDGES times and return the elapsed cycles
+ */
+static uint16_t runEdges()
+{
+  uint16_t start = TCNT1;
+  for (uint8_t i = 0; i < EDGES; ++i) {
+    PINB = _BV(0);
+    __asm__ __volatile__ ("nop\n\tnop\n\tnop\n\tnop\n\t");
+  }
+  return TCNT1 - start;
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  pinMode(8, OUTPUT);
+  setupPcint();
+
+  // Timer1 free running at the CPU clock, no millis() interrupts
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TIMSK0 = 0;
+
+  uint16_t minLatency = 0xFFFF;
+  uint16_t maxLatency = 0;
+  for (uint8_t i = 0; i < EDGES; ++i) {
+    entry = 0;
+    uint16_t start = TCNT1;
+    PINB = _BV(0);
+    __asm__ __volatile__ ("nop\n\tnop\n\tnop\n\tnop\n\t");
+    uint16_t latency = entry - start;
+    if (latency < minLatency) {
+      minLatency = latency;
+    }
+    if (latency > maxLatency) {
+      maxLatency = latency;
+    }
+  }
+
+  uint16_t with = runEdges();
+  enablePcint(false);
+  uint16_t without = runEdges();
+  enablePcint(true);
+
+  Serial.print(F("RESULT lib=EnableInterrupt latency_min="));
+  Serial.print(minLatency);
+  Serial.print(F(" latency_max="));
+  Serial.print(maxLatency);
+  Serial.print(F(" cycles="));
+  Serial.println((with - without) / EDGES);
+  Serial.flush();
+
+  // simavr stops when the CPU sleeps with interrupts off
+  cli();
+  SMCR = _BV(SE);
+  __asm__ __volatile__ ("sleep");
+}
+
+void loop()
+{
+}
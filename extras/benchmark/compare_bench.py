@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+#
+# compare_bench.py
+#
+# Compare two JSON result files of run_bench.py and highlight the
+# regressions in ISR cycles and footprint.
+#
+# Copyright (c) 2014 Kees Bakker
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# A metric that grows by more than --threshold percent is a regression.
+# The exit status is 1 when there is at least one.
+#
+# Usage:
+#   extras/benchmark/compare_bench.py [--threshold 0] old.json new.json
+
+import argparse
+import json
+import sys
+
+METRICS = ['latency_min', 'latency_max', 'cycles', 'wcet', 'flash', 'ram']
+
+
+def load(path):
+    with open(path) as f:
+        doc = json.load(f)
+    return doc, dict((r['bench'], r) for r in doc['results'])
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two benchmark result files')
+    parser.add_argument('old')
+    parser.add_argument('new')
+    parser.add_argument('--threshold', type=float, default=0.0,
+                        help='allowed increase in percent (default 0)')
+    args = parser.parse_args()
+
+    old_doc, old = load(args.old)
+    new_doc, new = load(args.new)
+    for key in ('mcu', 'fqbn', 'config'):
+        if old_doc.get(key) != new_doc.get(key):
+            print('note: %s differs: %r -> %r' % (key, old_doc.get(key), new_doc.get(key)))
+
+    regressions = 0
+    print('%-24s %-12s %8s %8s %8s' % ('bench', 'metric', 'old', 'new', 'delta'))
+    for bench in sorted(set(old) | set(new)):
+        if bench not in old or bench not in new:
+            print('%-24s %s' % (bench, 'only in ' + (args.old if bench in old else args.new)))
+            continue
+        for metric in METRICS:
+            a = old[bench].get(metric)
+            b = new[bench].get(metric)
+            if a is None or b is None:
+                continue
+            mark = ''
+            if b > a and (a == 0 or (b - a) * 100.0 / a > args.threshold):
+                mark = '  REGRESSION'
+                regressions += 1
+            elif b < a:
+                mark = '  improved'
+            print('%-24s %-12s %8d %8d %+8d%s' % (bench, metric, a, b, b - a, mark))
+
+    print('%d regression(s)' % regressions)
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,31 @@
+#!/bin/sh
+#
+# Benchmark the working tree against another revision of the library,
+# e.g. to measure the cycles saved by a change of the ISR.
+#
+# usage: extras/benchmark/compare_rev.sh [REV] [FLAGS]
+#
+#   REV    git revision to compare with, default HEAD~1
+#   FLAGS  compiler flags of both builds, default the options that use
+#          most of the per group state:
+#          "-DPCINT_PROFILING -DPCINT_BUDGETS -DPCINT_FILTERS"
+#
+# Only BenchSodaqPcInt is run.  Fails like compare_bench.py when the
+# working tree is slower or bigger.  Run it from the top of the library.
+
+REV="${1:-HEAD~1}"
+FLAGS="${2:--DPCINT_PROFILING -DPCINT_BUDGETS -DPCINT_FILTERS}"
+
+BENCH="$(dirname $0)"
+OUT=$(mktemp -d /tmp/pcint-rev.XXXXXX)
+trap 'git worktree remove --force ${OUT}/tree; rm -fr ${OUT}' EXIT
+
+git worktree add --detach "${OUT}/tree" "${REV}" > /dev/null || exit 1
+
+echo "== ${REV}"
+python3 ${BENCH}/run_bench.py --library "${OUT}/tree" --flags "${FLAGS}" \
+  --json "${OUT}/old.json" BenchSodaqPcInt || exit 1
+echo "== working tree"
+python3 ${BENCH}/run_bench.py --flags "${FLAGS}" \
+  --json "${OUT}/new.json" BenchSodaqPcInt || exit 1
+python3 ${BENCH}/compare_bench.py "${OUT}/old.json" "${OUT}/new.json"
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+#
+# run_bench.py
+#
+# Build the pin change benchmark sketches and run them in simavr, and
+# print a table with ISR latency, cycles per edge, flash and RAM for
+# Sodaq_PcInt, PinChangeInterrupt, EnableInterrupt and a hand-written
+# ISR.
+#
+# Copyright (c) 2014 Kees Bakker
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# Needs arduino-cli (with the arduino:avr core and the PinChangeInterrupt
+# and EnableInterrupt libraries installed), avr-size and simavr.
+#
+# With --json the results are also written as JSON (config, MCU and per
+# benchmark the cycles and sizes), for compare_bench.py.
+#
+# Usage:
+#   extras/benchmark/run_bench.py [--flags "-DPCINT_PROFILING"] [--json FILE]
+#                                 [--library DIR] [BENCH ...]
+
+import argparse
+import glob
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TOP = os.path.abspath(os.path.join(HERE, '..', '..'))
+
+sys.path.insert(0, os.path.join(TOP, 'extras', 'tools'))
+from pcint_wcet import PCINT_VECTORS, isr_cycles, parse_functions
+
+FQBN = 'arduino:avr:uno'
+MCU = 'atmega328p'
+FREQ = '16000000'
+
+BENCHES = ['BenchSodaqPcInt', 'BenchPinChangeInterrupt', 'BenchEnableInterrupt', 'BenchHandWritten']
+
+RESULT_RE = re.compile(r'RESULT\s+(.*)')
+
+
+def build(bench, outdir, flags, library):
+    cmd = ['arduino-cli', 'compile', '--fqbn', FQBN, '--library', library,
+           '--output-dir', outdir,
+           '--build-property', 'compiler.cpp.extra_flags=%s' % flags,
+           os.path.join(HERE, bench)]
+    subprocess.check_call(cmd, stdout=subprocess.DEVNULL)
+    return glob.glob(os.path.join(outdir, '*.elf'))[0]
+
+
+def sizes(elf):
+    """Flash and RAM bytes, like avr-size -C"""
+    out = subprocess.check_output(['avr-size', '-A', elf]).decode()
+    sec = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0].startswith('.') and parts[1].isdigit():
+            sec[parts[0]] = int(parts[1])
+    flash = sec.get('.text', 0) + sec.get('.data', 0)
+    ram = sec.get('.data', 0) + sec.get('.bss', 0) + sec.get('.noinit', 0)
+    return flash, ram
+
+
+def wcet(elf):
+    """Static worst case cycles of the PCINT0 ISR, without the handler,
+    counted like pcint_wcet.py"""
+    out = subprocess.check_output(['avr-objdump', '-d', elf]).decode('utf-8', 'replace')
+    name = '__vector_%d' % PCINT_VECTORS[MCU][0]
+    funcs = parse_functions(out.splitlines())
+    if name not in funcs:
+        return None
+    return isr_cycles(funcs, name, MCU)[1]
+
+
+def simulate(elf, timeout):
+    out = subprocess.run(['simavr', '-m', MCU, '-f', FREQ, elf],
+                         stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                         timeout=timeout).stdout.decode('utf-8', 'replace')
+    m = RESULT_RE.search(out)
+    if not m:
+        raise RuntimeError('no RESULT line from simavr:\n' + out)
+    result = {}
+    for item in m.group(1).split():
+        key, _, value = item.partition('=')
+        result[key] = int(value) if value.isdigit() else value
+    return result
+
+
+def run(benches, flags, timeout, library):
+    results = []
+    for bench in benches:
+        outdir = tempfile.mkdtemp(prefix='pcint-bench-')
+        try:
+            elf = build(bench, outdir, flags, library)
+            result = simulate(elf, timeout)
+            result['bench'] = bench
+            result['flash'], result['ram'] = sizes(elf)
+            result['wcet'] = wcet(elf)
+            results.append(result)
+        except (subprocess.CalledProcessError, subprocess.TimeoutExpired, RuntimeError) as e:
+            print('%s: %s' % (bench, e), file=sys.stderr)
+        finally:
+            shutil.rmtree(outdir)
+    return results
+
+
+def print_table(results):
+    print('%-20s %8s %8s %8s %8s %8s %8s' % ('library', 'lat.min', 'lat.max', 'cycles', 'wcet',
+                                             'flash', 'ram'))
+    for r in results:
+        print('%-20s %8d %8d %8d %8s %8d %8d' % (r['lib'], r['latency_min'], r['latency_max'],
+                                                 r['cycles'], r['wcet'], r['flash'], r['ram']))
+
+
+def write_json(path, results, flags):
+    doc = {
+        'fqbn': FQBN,
+        'mcu': MCU,
+        'f_cpu': int(FREQ),
+        'config': flags,
+        'results': results,
+    }
+    with open(path, 'w') as f:
+        json.dump(doc, f, indent=2, sort_keys=True)
+        f.write('\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pin change benchmark in simavr')
+    parser.add_argument('bench', nargs='*', default=BENCHES)
+    parser.add_argument('--flags', default='', help='extra compiler flags')
+    parser.add_argument('--timeout', type=int, default=60, help='simavr timeout (s)')
+    parser.add_argument('--json', help='write the results to this file')
+    parser.add_argument('--library', default=TOP,
+                        help='Sodaq_PcInt source tree to build with, default this one')
+    args = parser.parse_args()
+
+    results = run(args.bench, args.flags, args.timeout, os.path.abspath(args.library))
+    print_table(results)
+    if args.json:
+        write_json(args.json, results, args.flags)
+    if len(results) != len(args.bench):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,84 @@
+/*
+ * Arduino.h
+ *
+ * Host build of the PcInt library: the subset of the Arduino API and the
+ * Uno (ATmega328P) pin mapping that the library uses.  The registers are
+ * simulated, see pcint_sim.h.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef HOST_ARDUINO_H_
+#define HOST_ARDUINO_H_
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU           16000000UL
+#endif
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#define HIGH            1
+#define LOW             0
+
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+
+#define CHANGE          1
+#define FALLING         2
+#define RISING          3
+
+#define NOT_A_PIN       0
+#define NOT_A_PORT      0
+#define NOT_AN_INTERRUPT -1
+
+#define PB              2
+#define PC              3
+#define PD              4
+
+#define NUM_DIGITAL_PINS 20
+
+static const uint8_t A0 = 14;
+static const uint8_t A1 = 15;
+static const uint8_t A2 = 16;
+static const uint8_t A3 = 17;
+static const uint8_t A4 = 18;
+static const uint8_t A5 = 19;
+
+#define digitalPinToPCICR(p)    (((p) >= 0 && (p) <= 21) ? (&PCICR) : ((uint8_t *)0))
+#define digitalPinToPCICRbit(p) (((p) <= 7) ? 2 : (((p) <= 13) ? 0 : 1))
+#define digitalPinToPCMSK(p)    (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? (&PCMSK0) : (((p) <= 21) ? (&PCMSK1) : ((uint8_t *)0))))
+#define digitalPinToPCMSKbit(p) (((p) <= 7) ? (p) : (((p) <= 13) ? ((p) - 8) : ((p) - 14)))
+
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#define digitalPinToPort(p)     ((p) < NUM_DIGITAL_PINS ? ((p) <= 7 ? PD : ((p) <= 13 ? PB : PC)) : NOT_A_PORT)
+#define digitalPinToBitMask(p)  ((uint8_t)_BV(digitalPinToPCMSKbit(p)))
+#define portInputRegister(P)    ((P) == PB ? &PINB : ((P) == PC ? &PINC : ((P) == PD ? &PIND : (volatile uint8_t *)0)))
+#define portOutputRegister(P)   ((P) == PB ? &PORTB : ((P) == PC ? &PORTC : ((P) == PD ? &PORTD : (volatile uint8_t *)0)))
+#define portModeRegister(P)     ((P) == PB ? &DDRB : ((P) == PC ? &DDRC : ((P) == PD ? &DDRD : (volatile uint8_t *)0)))
+
+#define interrupts()            sei()
+#define noInterrupts()          cli()
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+unsigned long micros(void);
+unsigned long millis(void);
+void delayMicroseconds(unsigned int us);
+void delay(unsigned long ms);
+
+void attachInterrupt(uint8_t interruptNum, void (*func)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+
+#endif /* HOST_ARDUINO_H_ */
@@ -0,0 +1,25 @@
+/*
+ * avr/interrupt.h
+ *
+ * Host build: an ISR is a plain function, called by the simulator.
+ */
+
+#ifndef HOST_AVR_INTERRUPT_H_
+#define HOST_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+#define ISR(vector, ...) \
+  extern "C" void vector(void); \
+  extern "C" void vector(void)
+
+#define reti()          return
+
+#define cli()           (SREG &= ~_BV(SREG_I))
+#define sei()           (SREG |= _BV(SREG_I))
+
+#endif /* HOST_AVR_INTERRUPT_H_ */
@@ -0,0 +1,58 @@
+/*
+ * avr/io.h
+ *
+ * Host build: the ATmega328P registers used by the PcInt library, as
+ * plain variables.  They are thread_local: each thread is a separate
+ * virtual board.  See pcint_sim.h.
+ */
+
+#ifndef HOST_AVR_IO_H_
+#define HOST_AVR_IO_H_
+
+#include <stdint.h>
+
+#define _BV(bit)        (1 << (bit))
+
+extern thread_local volatile uint8_t SREG;
+extern thread_local volatile uint8_t GPIOR0;
+extern thread_local volatile uint8_t PCICR;
+extern thread_local volatile uint8_t PCIFR;
+extern thread_local volatile uint8_t PCMSK0;
+extern thread_local volatile uint8_t PCMSK1;
+extern thread_local volatile uint8_t PCMSK2;
+// Defined, as the registers of avr/io.h are macros
+#define PCMSK0          PCMSK0
+#define PCMSK1          PCMSK1
+#define PCMSK2          PCMSK2
+extern thread_local volatile uint8_t PINB;
+extern thread_local volatile uint8_t DDRB;
+extern thread_local volatile uint8_t PORTB;
+extern thread_local volatile uint8_t PINC;
+extern thread_local volatile uint8_t DDRC;
+extern thread_local volatile uint8_t PORTC;
+extern thread_local volatile uint8_t PIND;
+extern thread_local volatile uint8_t DDRD;
+extern thread_local volatile uint8_t PORTD;
+extern thread_local volatile uint8_t TCCR1A;
+extern thread_local volatile uint8_t TCCR1B;
+extern thread_local volatile uint16_t TCNT1;
+extern thread_local volatile uint8_t TIFR1;
+extern thread_local volatile uint8_t TIMSK1;
+
+// Access by data address, as in the pin tables of Sodaq_PcInt_pins.h
+volatile uint8_t * simRegister(uint16_t addr);
+#define _SFR_MEM8(addr) (*simRegister(addr))
+
+#define SREG_I          7
+#define CS10            0
+#define CS11            1
+#define CS12            2
+#define TOV1            0
+#define TOIE1           0
+
+#define PCINT0_vect     __vector_3
+#define PCINT1_vect     __vector_4
+#define PCINT2_vect     __vector_5
+#define TIMER1_OVF_vect __vector_13
+
+#endif /* HOST_AVR_IO_H_ */
@@ -0,0 +1,77 @@
+/*
+ * bench_inject.cpp
+ *
+ * Host benchmark of the PcInt dispatch path.  It runs a fixed number of
+ * events through PcInt::injectMask() and through the simulated pin
+ * change hardware, and reports the handler calls and the host time per
+ * event.  The counts are exact and repeatable; the times depend on the
+ * host.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include <Arduino.h>
+#include <Sodaq_PcInt.h>
+
+#include "pcint_sim.h"
+
+static uint32_t calls[8];
+
+static void handle8() { ++calls[0]; }
+static void handle9() { ++calls[1]; }
+static void handleA0() { ++calls[2]; }
+static void handleA1() { ++calls[3]; }
+
+#if defined(PCINT_COMPACT_HANDLERS)
+PCINT_HANDLER_TABLE(handle8, handle9, handleA0, handleA1);
+#endif
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint32_t totalCalls()
+{
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < 8; ++i) {
+    total += calls[i];
+  }
+  return total;
+}
+
+int main()
+{
+  const uint32_t events = 1000000;
+
+  simReset();
+  PcInt::attachInterrupt(8, handle8);
+  PcInt::attachInterrupt(9, handle9);
+  PcInt::attachInterrupt(A0, handleA0);
+  PcInt::attachInterrupt(A1, handleA1);
+
+  double start = seconds();
+  for (uint32_t i = 0; i < events; ++i) {
+    uint8_t bit = _BV(i & 1);
+    PcInt::injectMask(0, bit, (i & 2) ? bit : 0);
+  }
+  double elapsed = seconds() - start;
+  printf("inject:  %lu events, %lu handler calls, %.1f ns/event\n",
+         (unsigned long)events, (unsigned long)totalCalls(), elapsed * 1e9 / events);
+
+  for (uint8_t i = 0; i < 8; ++i) {
+    calls[i] = 0;
+  }
+  start = seconds();
+  for (uint32_t i = 0; i < events; ++i) {
+    simSetPin((i & 1) ? A1 : A0, (i >> 1) & 1);
+  }
+  elapsed = seconds() - start;
+  printf("pins:    %lu events, %lu ISRs, %lu handler calls, %.1f ns/event\n",
+         (unsigned long)events, (unsigned long)simIsrCount(1),
+         (unsigned long)totalCalls(), elapsed * 1e9 / events);
+  return 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# Build a host program with the PcInt library and the pin change
+# simulator.
+#
+# usage: extras/host/build.sh PROGRAM.cpp [OUTPUT] [EXTRA_FLAGS]
+#
+# e.g. extras/host/build.sh extras/host/bench_inject.cpp /tmp/bench "-DPCINT_FILTERS"
+#
+# With PLATFORM=samd the program is built for the SAMD21 backend, with the
+# simulated EIC of extras/host/samd instead of the AVR simulator.
+
+HOST="$(dirname $0)"
+TOP="${HOST}/../.."
+PROGRAM="$1"
+OUTPUT="${2:-a.out}"
+EXTRA_FLAGS="$3"
+
+[ -z "${PROGRAM}" ] && { echo "usage: $0 PROGRAM.cpp [OUTPUT] [EXTRA_FLAGS]"; exit 1; }
+
+if [ "${PLATFORM}" = "samd" ]; then
+  ${CXX:-g++} -std=gnu++11 -O2 -Wall -pthread -DPCINT_STATE=thread_local -DARDUINO_ARCH_SAMD ${EXTRA_FLAGS} \
+    -I"${HOST}/samd" -I"${TOP}/src" \
+    -o "${OUTPUT}" "${PROGRAM}" "${HOST}/samd/eic_sim.cpp" "${TOP}"/src/*.cpp
+  exit $?
+fi
+
+${CXX:-g++} -std=gnu++11 -O2 -Wall -pthread -DPCINT_STATE=thread_local -D__AVR_ATmega328P__ ${EXTRA_FLAGS} \
+  -I"${HOST}" -I"${TOP}/src" \
+  -o "${OUTPUT}" "${PROGRAM}" "${HOST}/pcint_sim.cpp" "${HOST}/pcint_wave.cpp" "${TOP}"/src/*.cpp
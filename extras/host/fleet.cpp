@@ -0,0 +1,154 @@
+/*
+ * fleet.cpp
+ *
+ * Simulate a fleet of stations, each a virtual board with the PcInt
+ * library and a rain gauge counter, on a pool of threads.  Every board
+ * plays a recorded trace (files given on the command line, used round
+ * robin) or, without traces, a synthetic one: bouncing reed switch
+ * contacts with a per board seed.  At the end the aggregate throughput
+ * is reported.
+ *
+ * usage: fleet [-b BOARDS] [-t THREADS] [-d SECONDS] [TRACE ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+#include <Sodaq_PcInt.h>
+
+#include "pcint_sim.h"
+#include "pcint_wave.h"
+
+#define RAIN_PIN        A0
+
+// The station firmware, per board like the library state
+static thread_local uint32_t rainTicks;
+static thread_local bool rainState;
+
+static void handleRain()
+{
+  if (digitalRead(RAIN_PIN) == LOW) {
+    if (!rainState) {
+      rainTicks++;
+      rainState = true;
+    }
+  } else {
+    rainState = false;
+  }
+}
+
+#if defined(PCINT_COMPACT_HANDLERS)
+PCINT_HANDLER_TABLE(handleRain);
+#endif
+
+struct BoardResult
+{
+  uint32_t ticks;
+  uint32_t isrs;
+  uint32_t toggles;
+  uint32_t simTime;
+};
+
+static void runBoard(uint32_t board, const std::vector<const char *> & traces,
+                     uint32_t seconds, BoardResult & result)
+{
+  simReset();
+  rainTicks = 0;
+  rainState = false;
+  pinMode(RAIN_PIN, INPUT);
+  PcInt::attachInterrupt(RAIN_PIN, handleRain);
+
+  SimWave wave(board + 1);
+  if (!traces.empty()) {
+    if (!wave.load(traces[board % traces.size()])) {
+      fprintf(stderr, "cannot read %s\n", traces[board % traces.size()]);
+    }
+  } else {
+    // The contact is open (high), a tip every 2..4 seconds closes it for
+    // 100 ms, each edge bouncing within 2 ms
+    simSetPin(RAIN_PIN, HIGH);
+    for (uint32_t t = 1000000; t < seconds * 1000000UL; t += 2000000 + (board * 7919 + t) % 2000000) {
+      wave.bounce(RAIN_PIN, t, 3, 2000);
+      wave.bounce(RAIN_PIN, t + 100000, 3, 2000);
+    }
+  }
+  simPlay(wave);
+  // The board runs for the whole duration, not only up to its last edge
+  simRunUntil(seconds * 1000000UL);
+
+  result.ticks = rainTicks;
+  result.isrs = simIsrCount(digitalPinToPCICRbit(RAIN_PIN));
+  result.toggles = wave.toggles().size();
+  result.simTime = simTime();
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char * argv[])
+{
+  uint32_t boards = 100;
+  uint32_t threads = std::thread::hardware_concurrency();
+  uint32_t duration = 3600;
+  std::vector<const char *> traces;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      boards = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      threads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      duration = atoi(argv[++i]);
+    } else {
+      traces.push_back(argv[i]);
+    }
+  }
+  if (threads == 0) {
+    threads = 1;
+  }
+
+  std::vector<BoardResult> results(boards);
+  std::atomic<uint32_t> next(0);
+  std::vector<std::thread> pool;
+  double start = seconds();
+  for (uint32_t t = 0; t < threads; ++t) {
+    pool.push_back(std::thread([&]() {
+      uint32_t board;
+      while ((board = next++) < boards) {
+        runBoard(board, traces, duration, results[board]);
+      }
+    }));
+  }
+  for (size_t t = 0; t < pool.size(); ++t) {
+    pool[t].join();
+  }
+  double elapsed = seconds() - start;
+
+  uint64_t ticks = 0;
+  uint64_t isrs = 0;
+  uint64_t toggles = 0;
+  double simSeconds = 0;
+  for (uint32_t b = 0; b < boards; ++b) {
+    ticks += results[b].ticks;
+    isrs += results[b].isrs;
+    toggles += results[b].toggles;
+    simSeconds += results[b].simTime / 1e6;
+  }
+  printf("boards:     %lu on %lu threads\n", (unsigned long)boards, (unsigned long)threads);
+  printf("simulated:  %.0f board-seconds, %llu toggles, %llu ISRs, %llu rain ticks\n",
+         simSeconds, (unsigned long long)toggles, (unsigned long long)isrs, (unsigned long long)ticks);
+  printf("wall time:  %.3f s\n", elapsed);
+  printf("throughput: %.0f events/s, %.0f x real time\n", toggles / elapsed, simSeconds / elapsed);
+  return 0;
+}
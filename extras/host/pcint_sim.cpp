@@ -0,0 +1,435 @@
+/*
+ * pcint_sim.cpp
+ *
+ * Host simulation of the ATmega328P pin change hardware.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "pcint_sim.h"
+
+thread_local volatile uint8_t SREG;
+thread_local volatile uint8_t GPIOR0;
+thread_local volatile uint8_t PCICR;
+thread_local volatile uint8_t PCIFR;
+thread_local volatile uint8_t PCMSK0;
+thread_local volatile uint8_t PCMSK1;
+thread_local volatile uint8_t PCMSK2;
+thread_local volatile uint8_t PINB;
+thread_local volatile uint8_t DDRB;
+thread_local volatile uint8_t PORTB;
+thread_local volatile uint8_t PINC;
+thread_local volatile uint8_t DDRC;
+thread_local volatile uint8_t PORTC;
+thread_local volatile uint8_t PIND;
+thread_local volatile uint8_t DDRD;
+thread_local volatile uint8_t PORTD;
+thread_local volatile uint8_t TCCR1A;
+thread_local volatile uint8_t TCCR1B;
+thread_local volatile uint16_t TCNT1;
+thread_local volatile uint8_t TIFR1;
+thread_local volatile uint8_t TIMSK1;
+
+// Weak, so programs without them (e.g. PCINT_NO_ISR) still link
+extern "C" void PCINT0_vect(void) __attribute__((weak));
+extern "C" void PCINT1_vect(void) __attribute__((weak));
+extern "C" void PCINT2_vect(void) __attribute__((weak));
+extern "C" void TIMER1_OVF_vect(void) __attribute__((weak));
+
+#define CYCLES_PER_US   (F_CPU / 1000000UL)
+
+/*
+ * All the state below is per thread, a thread runs one virtual board at
+ * a time.
+ */
+
+struct SimEvent
+{
+  uint64_t cycle;
+  uint32_t seq;
+  void (*func)(void * arg);
+  void * arg;
+};
+
+static thread_local uint64_t simClock;
+static thread_local uint32_t simTimer1Rest;
+static thread_local uint32_t simIsrCost;
+static thread_local std::vector<SimEvent> simEvents;
+static thread_local uint32_t simEventSeq;
+static thread_local uint8_t simInput[3];
+static thread_local uint32_t simIsrCounts[3];
+
+// The external interrupts INT0 (pin 2) and INT1 (pin 3), PD2 and PD3
+static thread_local void (*simExtFuncs[2])(void);
+static thread_local int simExtModes[2];
+static thread_local uint8_t simExtPending;
+
+/*
+ * Timer1 prescaler from the clock select bits, 0 when stopped
+ */
+static uint32_t timer1Prescaler()
+{
+  static const uint16_t prescalers[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+  return prescalers[TCCR1B & (_BV(CS12) | _BV(CS11) | _BV(CS10))];
+}
+
+/*
+ * Move the clock and Timer1 forward.  Stops early at a Timer1 overflow
+ * and returns the cycles that are left.
+ */
+static uint64_t step(uint64_t cycles)
+{
+  uint32_t prescaler = timer1Prescaler();
+  if (prescaler == 0) {
+    simClock += cycles;
+    return 0;
+  }
+  uint64_t toOverflow = (uint64_t)(0x10000UL - TCNT1) * prescaler - simTimer1Rest;
+  if (cycles < toOverflow) {
+    uint64_t ticks = (simTimer1Rest + cycles) / prescaler;
+    simTimer1Rest = (simTimer1Rest + cycles) % prescaler;
+    TCNT1 += ticks;
+    simClock += cycles;
+    return 0;
+  }
+  simClock += toOverflow;
+  simTimer1Rest = 0;
+  TCNT1 = 0;
+  TIFR1 |= _BV(TOV1);
+  return cycles - toOverflow;
+}
+
+/*
+ * The PCINT group of a port: PB is group 0, PC group 1, PD group 2
+ */
+static uint8_t portGroup(uint8_t port)
+{
+  return port - PB;
+}
+
+static volatile uint8_t * groupMask(uint8_t group)
+{
+  return group == 0 ? &PCMSK0 : (group == 1 ? &PCMSK1 : &PCMSK2);
+}
+
+/*
+ * Recompute PINx from the external levels and the outputs, and flag
+ * a pin change interrupt for the enabled pins that changed
+ */
+static void updatePort(uint8_t port)
+{
+  uint8_t group = portGroup(port);
+  volatile uint8_t * pin = portInputRegister(port);
+  uint8_t ddr = *portModeRegister(port);
+  uint8_t value = (ddr & *portOutputRegister(port)) | (~ddr & simInput[group]);
+  uint8_t changed = *pin ^ value;
+  *pin = value;
+  if (changed & *groupMask(group)) {
+    PCIFR |= _BV(group);
+  }
+  if (port == PD) {
+    for (uint8_t num = 0; num < 2; ++num) {
+      uint8_t bit = _BV(2 + num);
+      int mode = simExtModes[num];
+      if (simExtFuncs[num] && (changed & bit) &&
+          (mode == CHANGE || mode == ((value & bit) ? RISING : FALLING))) {
+        simExtPending |= _BV(num);
+      }
+    }
+  }
+  simService();
+}
+
+void simReset()
+{
+  SREG = _BV(SREG_I);
+  GPIOR0 = 0;
+  PCICR = PCIFR = 0;
+  PCMSK0 = PCMSK1 = PCMSK2 = 0;
+  PINB = DDRB = PORTB = 0;
+  PINC = DDRC = PORTC = 0;
+  PIND = DDRD = PORTD = 0;
+  TCCR1A = TCCR1B = 0;
+  TCNT1 = 0;
+  TIFR1 = TIMSK1 = 0;
+  simClock = 0;
+  simTimer1Rest = 0;
+  simIsrCost = 0;
+  simEvents.clear();
+  simEventSeq = 0;
+  for (uint8_t i = 0; i < 3; ++i) {
+    simInput[i] = 0;
+    simIsrCounts[i] = 0;
+  }
+  simExtFuncs[0] = simExtFuncs[1] = 0;
+  simExtPending = 0;
+}
+
+void simSetPin(uint8_t pin, uint8_t level)
+{
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PORT) {
+    return;
+  }
+  uint8_t group = portGroup(port);
+  if (level) {
+    simInput[group] |= digitalPinToBitMask(pin);
+  } else {
+    simInput[group] &= ~digitalPinToBitMask(pin);
+  }
+  updatePort(port);
+}
+
+uint8_t simGetPin(uint8_t pin)
+{
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PORT) {
+    return LOW;
+  }
+  return (simInput[portGroup(port)] & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+void simSetPort(uint8_t port, uint8_t value)
+{
+  simInput[portGroup(port)] = value;
+  updatePort(port);
+}
+
+/*
+ * Like the AVR: the lowest pending vector goes first (INT0, INT1, then
+ * the PCINT groups), the flag is cleared on entry and interrupts are
+ * disabled while the ISR runs.
+ */
+void simService()
+{
+  while (SREG & _BV(SREG_I)) {
+    uint8_t pending = PCIFR & PCICR;
+    if (simExtPending) {
+      uint8_t num = (simExtPending & 1) ? 0 : 1;
+      simExtPending &= ~_BV(num);
+      cli();
+      simConsume(simIsrCost);
+      if (simExtFuncs[num]) {
+        simExtFuncs[num]();
+      }
+      sei();
+    } else if (pending) {
+      uint8_t group = 0;
+      while (!(pending & _BV(group))) {
+        ++group;
+      }
+      PCIFR &= ~_BV(group);
+      ++simIsrCounts[group];
+      cli();
+      simConsume(simIsrCost);
+      void (*vector)(void) = group == 0 ? PCINT0_vect : (group == 1 ? PCINT1_vect : PCINT2_vect);
+      if (vector) {
+        vector();
+      }
+      sei();
+    } else if ((TIFR1 & _BV(TOV1)) && (TIMSK1 & _BV(TOIE1))) {
+      TIFR1 &= ~_BV(TOV1);
+      cli();
+      simConsume(simIsrCost);
+      if (TIMER1_OVF_vect) {
+        TIMER1_OVF_vect();
+      }
+      sei();
+    } else {
+      break;
+    }
+  }
+}
+
+uint32_t simTime()
+{
+  return simClock / CYCLES_PER_US;
+}
+
+uint64_t simCycles()
+{
+  return simClock;
+}
+
+void simConsume(uint32_t cycles)
+{
+  uint64_t left = cycles;
+  while (left) {
+    left = step(left);
+  }
+}
+
+static bool later(const SimEvent & a, const SimEvent & b)
+{
+  return a.cycle != b.cycle ? a.cycle > b.cycle : a.seq > b.seq;
+}
+
+void simSchedule(uint32_t time, void (*func)(void * arg), void * arg)
+{
+  SimEvent event;
+  event.cycle = (uint64_t)time * CYCLES_PER_US;
+  event.seq = simEventSeq++;
+  event.func = func;
+  event.arg = arg;
+  simEvents.push_back(event);
+  std::push_heap(simEvents.begin(), simEvents.end(), later);
+}
+
+/*
+ * Run the scheduled events and the interrupts up to the given time.  The
+ * clock stops at every event and every Timer1 overflow.
+ */
+void simRunUntil(uint32_t time)
+{
+  uint64_t end = (uint64_t)time * CYCLES_PER_US;
+  while (true) {
+    simService();
+    if (!simEvents.empty() && simEvents.front().cycle <= simClock) {
+      std::pop_heap(simEvents.begin(), simEvents.end(), later);
+      SimEvent event = simEvents.back();
+      simEvents.pop_back();
+      event.func(event.arg);
+      continue;
+    }
+    uint64_t target = end;
+    if (!simEvents.empty() && simEvents.front().cycle < target) {
+      target = simEvents.front().cycle;
+    }
+    if (target <= simClock) {
+      break;
+    }
+    // Stops early at a Timer1 overflow, which is serviced first
+    step(target - simClock);
+  }
+}
+
+void simAdvance(uint32_t us)
+{
+  simRunUntil(simTime() + us);
+}
+
+void simSetIsrCycles(uint32_t cycles)
+{
+  simIsrCost = cycles;
+}
+
+volatile uint8_t * simRegister(uint16_t addr)
+{
+  switch (addr) {
+  case 0x23: return &PINB;
+  case 0x24: return &DDRB;
+  case 0x25: return &PORTB;
+  case 0x26: return &PINC;
+  case 0x27: return &DDRC;
+  case 0x28: return &PORTC;
+  case 0x29: return &PIND;
+  case 0x2A: return &DDRD;
+  case 0x2B: return &PORTD;
+  case 0x3B: return &PCIFR;
+  case 0x3E: return &GPIOR0;
+  case 0x5F: return &SREG;
+  case 0x68: return &PCICR;
+  case 0x6B: return &PCMSK0;
+  case 0x6C: return &PCMSK1;
+  case 0x6D: return &PCMSK2;
+  }
+  fprintf(stderr, "simRegister: no register at 0x%02X\n", addr);
+  abort();
+}
+
+uint32_t simIsrCount(uint8_t group)
+{
+  return group < 3 ? simIsrCounts[group] : 0;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PORT) {
+    return;
+  }
+  uint8_t bit = digitalPinToBitMask(pin);
+  if (mode == OUTPUT) {
+    *portModeRegister(port) |= bit;
+  } else {
+    *portModeRegister(port) &= ~bit;
+    if (mode == INPUT_PULLUP) {
+      *portOutputRegister(port) |= bit;
+    } else {
+      *portOutputRegister(port) &= ~bit;
+    }
+  }
+  updatePort(port);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PORT) {
+    return;
+  }
+  if (val) {
+    *portOutputRegister(port) |= digitalPinToBitMask(pin);
+  } else {
+    *portOutputRegister(port) &= ~digitalPinToBitMask(pin);
+  }
+  updatePort(port);
+}
+
+int digitalRead(uint8_t pin)
+{
+  uint8_t port = digitalPinToPort(pin);
+  if (port == NOT_A_PORT) {
+    return LOW;
+  }
+  return (*portInputRegister(port) & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+unsigned long micros(void)
+{
+  return simTime();
+}
+
+unsigned long millis(void)
+{
+  return simTime() / 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  simAdvance(us);
+}
+
+void delay(unsigned long ms)
+{
+  simAdvance(ms * 1000);
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*func)(void), int mode)
+{
+  if (interruptNum < 2) {
+    simExtFuncs[interruptNum] = func;
+    simExtModes[interruptNum] = mode;
+  }
+}
+
+void detachInterrupt(uint8_t interruptNum)
+{
+  if (interruptNum < 2) {
+    simExtFuncs[interruptNum] = 0;
+    simExtPending &= ~_BV(interruptNum);
+  }
+}
@@ -0,0 +1,68 @@
+/*
+ * pcint_sim.h
+ *
+ * Host simulation of the ATmega328P pin change hardware, to run the
+ * PcInt library and its handlers on a PC.  Setting an input level
+ * updates PINx and, when enabled in PCMSKn/PCICR, calls the
+ * ISR(PCINTn_vect) of the library, just like the AVR does.  The core's
+ * attachInterrupt() works for INT0 and INT1 (pins 2 and 3), with the
+ * CHANGE, RISING and FALLING modes.
+ *
+ * Time is virtual.  It is kept in CPU cycles (F_CPU) and only moves when
+ * the simulation advances it, so runs are deterministic and much faster
+ * than real time.  micros() and millis() follow the virtual clock, and
+ * Timer1 (TCNT1, TOV1 and TIMER1_OVF_vect) counts with it.
+ *
+ * The registers, the simulator and the library (PCINT_STATE) keep their
+ * state per thread.  Each thread simulates its own board, so many boards
+ * can run in parallel, see fleet.cpp.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef PCINT_SIM_H_
+#define PCINT_SIM_H_
+
+#include <stdint.h>
+
+// Reset all registers and the clock
+void simReset();
+
+// Set the external level of an input pin
+void simSetPin(uint8_t pin, uint8_t level);
+// Get the external level of an input pin
+uint8_t simGetPin(uint8_t pin);
+// Set the external levels of all input pins of a port (PB, PC, PD)
+void simSetPort(uint8_t port, uint8_t value);
+
+// Run the pending pin change interrupts, if interrupts are enabled
+void simService();
+
+// The simulated time in microseconds and in CPU cycles
+uint32_t simTime();
+uint64_t simCycles();
+
+// Advance the clock, running the scheduled events and the Timer1
+// overflows at their exact time
+void simAdvance(uint32_t us);
+void simRunUntil(uint32_t time);
+
+// Call func(arg) at the given simulated time (microseconds).  Events at
+// the same time run in the order they were scheduled.
+void simSchedule(uint32_t time, void (*func)(void * arg), void * arg);
+
+// Let CPU time pass inside an ISR or handler.  Timer1 counts, but
+// events and interrupts wait until the code returns.
+void simConsume(uint32_t cycles);
+// CPU cycles consumed by the hardware and the ISR prologue per interrupt
+void simSetIsrCycles(uint32_t cycles);
+
+// Number of ISR calls per PCINT group since simReset()
+uint32_t simIsrCount(uint8_t group);
+
+#endif /* PCINT_SIM_H_ */
@@ -0,0 +1,179 @@
+/*
+ * pcint_wave.cpp
+ *
+ * Synthetic input signals for the host simulation.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+
+#include <Arduino.h>
+
+#include "pcint_sim.h"
+#include "pcint_wave.h"
+
+SimWave::SimWave(uint32_t seed) : _sorted(true), _rng(seed)
+{
+}
+
+void SimWave::toggle(uint8_t pin, uint32_t time)
+{
+  SimToggle t;
+  t.time = time;
+  t.pin = pin;
+  _toggles.push_back(t);
+  _sorted = false;
+}
+
+/*
+ * A random number in [0, range)
+ */
+uint32_t SimWave::random(uint32_t range)
+{
+  if (range == 0) {
+    return 0;
+  }
+  return std::uniform_int_distribution<uint32_t>(0, range - 1)(_rng);
+}
+
+void SimWave::square(uint8_t pin, uint32_t start, uint32_t period, uint32_t high, uint32_t cycles)
+{
+  for (uint32_t i = 0; i < cycles; ++i) {
+    toggle(pin, start + i * period);
+    toggle(pin, start + i * period + high);
+  }
+}
+
+void SimWave::bounce(uint8_t pin, uint32_t time, uint8_t bounces, uint32_t window)
+{
+  toggle(pin, time);
+  for (uint8_t i = 0; i < bounces; ++i) {
+    uint32_t a = time + 1 + random(window);
+    uint32_t b = time + 1 + random(window);
+    toggle(pin, std::min(a, b));
+    toggle(pin, std::max(a, b) + 1);
+  }
+}
+
+void SimWave::button(uint8_t pin, uint32_t start, uint32_t period, uint32_t count,
+                     uint8_t bounces, uint32_t window)
+{
+  for (uint32_t i = 0; i < count; ++i) {
+    bounce(pin, start + i * period, bounces, window);
+    bounce(pin, start + i * period + period / 2, bounces, window);
+  }
+}
+
+/*
+ * Gray code: A leads B for one direction, B leads A for the other
+ */
+void SimWave::quadrature(uint8_t pinA, uint8_t pinB, uint32_t start, uint32_t stepTime,
+                         uint32_t steps, double reverse)
+{
+  std::bernoulli_distribution flip(reverse);
+  uint8_t phase = 0;
+  bool forward = true;
+  for (uint32_t i = 0; i < steps; ++i) {
+    if (flip(_rng)) {
+      forward = !forward;
+    }
+    // Phases 0..3 are AB = 00, 10, 11, 01.  Going forward from 0 or 2
+    // toggles A, from 1 or 3 toggles B.  Backward is the opposite.
+    uint8_t next = forward ? (phase + 1) & 3 : (phase + 3) & 3;
+    bool toggleA = forward ? (phase & 1) == 0 : (next & 1) == 0;
+    toggle(toggleA ? pinA : pinB, start + i * stepTime);
+    phase = next;
+  }
+}
+
+void SimWave::burst(uint8_t pin, uint32_t start, uint32_t duration, uint32_t bursts,
+                    uint8_t pulses, uint32_t pulseWidth)
+{
+  for (uint32_t i = 0; i < bursts; ++i) {
+    uint32_t time = start + random(duration);
+    for (uint8_t p = 0; p < pulses; ++p) {
+      uint32_t width = 1 + random(pulseWidth);
+      toggle(pin, time);
+      toggle(pin, time + width);
+      time += width + 1 + random(pulseWidth);
+    }
+  }
+}
+
+void SimWave::jitter(double sigma)
+{
+  std::normal_distribution<double> offset(0.0, sigma);
+  for (size_t i = 0; i < _toggles.size(); ++i) {
+    double time = _toggles[i].time + offset(_rng);
+    _toggles[i].time = time < 0 ? 0 : (uint32_t)(time + 0.5);
+  }
+  _sorted = false;
+}
+
+void SimWave::add(const SimWave & other)
+{
+  _toggles.insert(_toggles.end(), other._toggles.begin(), other._toggles.end());
+  _sorted = false;
+}
+
+bool SimWave::load(const char * path)
+{
+  FILE * f = fopen(path, "r");
+  if (!f) {
+    return false;
+  }
+  uint8_t levels[NUM_DIGITAL_PINS] = { 0 };
+  unsigned long time;
+  unsigned pin;
+  unsigned level;
+  char line[80];
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, "%lu %u %u", &time, &pin, &level) != 3 || pin >= NUM_DIGITAL_PINS) {
+      continue;
+    }
+    if ((level != 0) != (levels[pin] != 0)) {
+      toggle(pin, time);
+      levels[pin] = level != 0;
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+static bool earlier(const SimToggle & a, const SimToggle & b)
+{
+  return a.time < b.time;
+}
+
+const std::vector<SimToggle> & SimWave::toggles()
+{
+  if (!_sorted) {
+    std::stable_sort(_toggles.begin(), _toggles.end(), earlier);
+    _sorted = true;
+  }
+  return _toggles;
+}
+
+uint32_t SimWave::endTime()
+{
+  return toggles().empty() ? 0 : _toggles.back().time;
+}
+
+void simPlay(SimWave & wave)
+{
+  const std::vector<SimToggle> & toggles = wave.toggles();
+  for (size_t i = 0; i < toggles.size(); ++i) {
+    if (toggles[i].time > simTime()) {
+      simAdvance(toggles[i].time - simTime());
+    }
+    simSetPin(toggles[i].pin, !simGetPin(toggles[i].pin));
+  }
+}
@@ -0,0 +1,85 @@
+/*
+ * pcint_wave.h
+ *
+ * Synthetic input signals for the host simulation.  A SimWave is a list
+ * of pin toggles in simulated time.  The generators add toggles, so
+ * signals combine by XOR: a square wave plus burst noise on the same pin
+ * is the noisy square wave.  Random generators use the seed given to the
+ * constructor, so a wave is repeatable.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef PCINT_WAVE_H_
+#define PCINT_WAVE_H_
+
+#include <stdint.h>
+
+#include <random>
+#include <vector>
+
+struct SimToggle
+{
+  uint32_t time;                // microseconds
+  uint8_t pin;
+};
+
+class SimWave
+{
+public:
+  explicit SimWave(uint32_t seed = 1);
+
+  // Square wave: high for 'high' us of each period, starting high at start
+  void square(uint8_t pin, uint32_t start, uint32_t period, uint32_t high, uint32_t cycles);
+
+  // One transition at time, followed by 'bounces' pairs of random
+  // toggles within window us (contact bounce)
+  void bounce(uint8_t pin, uint32_t time, uint8_t bounces, uint32_t window);
+
+  // Pressing and releasing a button every period, each edge with bounce
+  void button(uint8_t pin, uint32_t start, uint32_t period, uint32_t count,
+              uint8_t bounces, uint32_t window);
+
+  // Quadrature encoder: one step per stepTime us, each step reverses the
+  // direction with the given probability
+  void quadrature(uint8_t pinA, uint8_t pinB, uint32_t start, uint32_t stepTime,
+                  uint32_t steps, double reverse);
+
+  // Burst noise: 'bursts' bursts at random times in [start, start+duration),
+  // each of 'pulses' glitches of at most pulseWidth us
+  void burst(uint8_t pin, uint32_t start, uint32_t duration, uint32_t bursts,
+             uint8_t pulses, uint32_t pulseWidth);
+
+  // Move every toggle by a Gaussian offset with standard deviation sigma us
+  void jitter(double sigma);
+
+  // Append all toggles of another wave
+  void add(const SimWave & other);
+
+  // Read a recorded trace: one "time pin level" line per sample, time in
+  // microseconds.  All pins start low.  Returns false if it cannot be read.
+  bool load(const char * path);
+
+  // The toggles, sorted by time
+  const std::vector<SimToggle> & toggles();
+  uint32_t endTime();
+
+private:
+  void toggle(uint8_t pin, uint32_t time);
+  uint32_t random(uint32_t range);
+
+  std::vector<SimToggle> _toggles;
+  bool _sorted;
+  std::mt19937 _rng;
+};
+
+// Play a wave into the simulated pins, advancing the simulated time to
+// each toggle.  Toggles before the current time are applied right away.
+void simPlay(SimWave & wave);
+
+#endif /* PCINT_WAVE_H_ */
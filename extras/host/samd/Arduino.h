@@ -0,0 +1,136 @@
+/*
+ * Arduino.h
+ *
+ * Host build of the SAMD21 backend: the subset of the Arduino SAMD core
+ * and of the CMSIS headers that Sodaq_PcInt_samd.cpp uses, with a
+ * simulated EIC and the core's attachInterrupt() and EIC_Handler().  The board has EXTINT n on pin n for pins 0..15; pins
+ * 16..19 have no interrupt.  See eic_sim.h.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ */
+
+#ifndef HOST_SAMD_ARDUINO_H_
+#define HOST_SAMD_ARDUINO_H_
+
+#include <stdint.h>
+
+#define HIGH            1
+#define LOW             0
+
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+
+// The values of the SAMD core
+#define CHANGE          2
+#define FALLING         3
+#define RISING          4
+
+#define PINS_COUNT      20
+
+typedef enum
+{
+  EXTERNAL_INT_0 = 0,
+  EXTERNAL_INT_15 = 15,
+  EXTERNAL_INT_NMI = 16,
+  EXTERNAL_NUM_INTERRUPTS,
+  NOT_AN_INTERRUPT = -1,
+} EExt_Interrupts;
+
+typedef struct
+{
+  EExt_Interrupts ulExtInt;
+} PinDescription;
+
+extern const PinDescription g_APinDescription[PINS_COUNT];
+
+/*
+ * A register that is cleared by writing ones to it (INTFLAG), and a
+ * pair of registers that set and clear one mask (INTENSET/INTENCLR)
+ */
+struct SimW1C
+{
+  uint32_t value;
+  void operator=(uint32_t v) volatile { value &= ~v; }
+  operator uint32_t() const volatile { return value; }
+};
+
+extern thread_local uint32_t simEicIntEn;
+
+struct SimIntEnSet
+{
+  void operator=(uint32_t v) volatile { simEicIntEn |= v; }
+  operator uint32_t() const volatile { return simEicIntEn; }
+};
+
+struct SimIntEnClr
+{
+  void operator=(uint32_t v) volatile { simEicIntEn &= ~v; }
+  operator uint32_t() const volatile { return simEicIntEn; }
+};
+
+typedef struct
+{
+  union { struct { uint8_t SWRST:1; uint8_t ENABLE:1; } bit; uint8_t reg; } CTRL;
+  union { struct { uint8_t :7; uint8_t SYNCBUSY:1; } bit; uint8_t reg; } STATUS;
+  struct { SimIntEnClr reg; } INTENCLR;
+  struct { SimIntEnSet reg; } INTENSET;
+  struct { SimW1C reg; } INTFLAG;
+  struct { uint32_t reg; } CONFIG[2];
+} Eic;
+
+typedef struct
+{
+  struct { uint16_t reg; } CLKCTRL;
+  union { struct { uint8_t :7; uint8_t SYNCBUSY:1; } bit; uint8_t reg; } STATUS;
+} Gclk;
+
+extern thread_local volatile Eic simEic;
+extern thread_local volatile Gclk simGclk;
+
+#define EIC                             (&simEic)
+#define GCLK                            (&simGclk)
+
+#define EIC_CONFIG_SENSE0_NONE_Val      0x0
+#define EIC_CONFIG_SENSE0_RISE_Val      0x1
+#define EIC_CONFIG_SENSE0_FALL_Val      0x2
+#define EIC_CONFIG_SENSE0_BOTH_Val      0x3
+#define EIC_CONFIG_FILTEN0              (1 << 3)
+#define EIC_INTENCLR_EXTINT(v)          ((uint32_t)(v))
+#define EIC_INTENSET_EXTINT(v)          ((uint32_t)(v))
+#define EIC_INTFLAG_EXTINT(v)           ((uint32_t)(v))
+
+#define GCLK_CLKCTRL_CLKEN              (1 << 14)
+#define GCLK_CLKCTRL_GEN_GCLK0          (0 << 8)
+#define GCLK_CLKCTRL_ID(v)              (v)
+#define GCM_EIC                         5
+
+typedef enum { EIC_IRQn = 4 } IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+
+#define interrupts()            __enable_irq()
+#define noInterrupts()          __disable_irq()
+
+void pinMode(uint32_t pin, uint32_t mode);
+int digitalRead(uint32_t pin);
+
+// WInterrupts.h of the core
+typedef void (*voidFuncPtr)(void);
+extern "C" void attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode);
+extern "C" void detachInterrupt(uint32_t pin);
+
+#endif /* HOST_SAMD_ARDUINO_H_ */
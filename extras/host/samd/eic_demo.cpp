@@ -0,0 +1,95 @@
+/*
+ * eic_demo.cpp
+ *
+ * Run the SAMD21 backend of the PcInt library against the simulated EIC:
+ * edge selection, the majority filter, disable/enable and detach, next
+ * to a handler of the core's attachInterrupt(), and PcInt::inject().
+ *
+ *   PLATFORM=samd extras/host/build.sh extras/host/samd/eic_demo.cpp eic_demo
+ *   PLATFORM=samd extras/host/build.sh extras/host/samd/eic_demo.cpp eic_demo -DPCINT_EIC_FILTER
+ */
+
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <Sodaq_PcInt.h>
+
+#include "eic_sim.h"
+
+static uint32_t changes;
+static uint32_t rises;
+static uint32_t falls;
+static uint32_t coreRises;
+static uint32_t highRises;
+
+static void handleChange() { ++changes; }
+static void handleRise() { ++rises; }
+static void handleFall() { ++falls; }
+static void handleCore() { ++coreRises; }
+static void handleHighRise() { ++highRises; }
+
+static void pulses(uint8_t pin, int count)
+{
+  for (int i = 0; i < count; ++i) {
+    simEicSetPin(pin, HIGH);
+    simEicSetPin(pin, LOW);
+  }
+}
+
+int main()
+{
+  simEicReset();
+  PcInt::attachInterrupt(2, handleChange);
+  PcInt::attachInterrupt(3, handleRise, RISING);
+  PcInt::attachInterrupt(4, handleFall, FALLING);
+  PcInt::attachInterrupt(17, handleChange);     // no EXTINT, ignored
+  attachInterrupt(5, handleCore, RISING);       // the core's
+
+  pulses(2, 10);
+  pulses(3, 10);
+  pulses(4, 10);
+  pulses(5, 10);
+  printf("edges:    change=%lu rise=%lu fall=%lu core=%lu (expect 20 10 10 10)\n",
+         (unsigned long)changes, (unsigned long)rises, (unsigned long)falls, (unsigned long)coreRises);
+
+  simEicGlitch(2);
+  printf("glitch:   change=%lu (%s)\n", (unsigned long)changes,
+#if defined(PCINT_EIC_FILTER)
+         "filtered, expect 20"
+#else
+         "not filtered, both edges in one flag, expect 21"
+#endif
+         );
+
+  uint32_t before = changes;
+  PcInt::disableInterrupt(2);
+  pulses(2, 5);
+  PcInt::enableInterrupt(2);
+  pulses(2, 1);
+  pulses(5, 1);
+  printf("disabled: change=+%lu core=%lu (expect 2 11)\n", (unsigned long)(changes - before),
+         (unsigned long)coreRises);
+
+  PcInt::detachInterrupt(3);
+  pulses(3, 5);
+  printf("detached: rise=%lu (expect 10) getFunc(0, 3)=%s\n", (unsigned long)rises,
+         PcInt::getFunc(0, 3) ? "set" : "0");
+
+  // Channel 12 is above the low 8, inject() follows the edge modes
+  PcInt::attachInterrupt(12, handleHighRise, RISING);
+  before = changes;
+  uint32_t fallsBefore = falls;
+  for (int i = 0; i < 3; ++i) {
+    PcInt::inject(12, HIGH);
+    PcInt::inject(12, LOW);
+    PcInt::inject(2, HIGH);
+    PcInt::inject(2, LOW);
+    PcInt::inject(4, HIGH);
+    PcInt::inject(4, LOW);
+  }
+  printf("inject:   rise12=%lu change=+%lu fall=+%lu (expect 3 6 3)\n", (unsigned long)highRises,
+         (unsigned long)(changes - before), (unsigned long)(falls - fallsBefore));
+
+  printf("ISRs:     %lu\n", (unsigned long)simEicIsrCount());
+  return 0;
+}
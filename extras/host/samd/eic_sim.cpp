@@ -0,0 +1,260 @@
+/*
+ * eic_sim.cpp
+ *
+ * Host simulation of the SAMD21 External Interrupt Controller.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <string.h>
+
+#include <Arduino.h>
+#include <wiring_private.h>
+
+#include "eic_sim.h"
+
+// EXTINT n on pin n for pins 0..15
+const PinDescription g_APinDescription[PINS_COUNT] = {
+  { (EExt_Interrupts)0 }, { (EExt_Interrupts)1 }, { (EExt_Interrupts)2 }, { (EExt_Interrupts)3 },
+  { (EExt_Interrupts)4 }, { (EExt_Interrupts)5 }, { (EExt_Interrupts)6 }, { (EExt_Interrupts)7 },
+  { (EExt_Interrupts)8 }, { (EExt_Interrupts)9 }, { (EExt_Interrupts)10 }, { (EExt_Interrupts)11 },
+  { (EExt_Interrupts)12 }, { (EExt_Interrupts)13 }, { (EExt_Interrupts)14 }, { (EExt_Interrupts)15 },
+  { NOT_AN_INTERRUPT }, { NOT_AN_INTERRUPT }, { NOT_AN_INTERRUPT }, { NOT_AN_INTERRUPT },
+};
+
+thread_local uint32_t simEicIntEn;
+thread_local volatile Eic simEic;
+thread_local volatile Gclk simGclk;
+
+static thread_local uint8_t simLevels[PINS_COUNT];
+static thread_local bool simMuxed[PINS_COUNT];
+static thread_local bool simNvicEnabled;
+static thread_local bool simIrqEnabled;
+static thread_local bool simInIsr;
+static thread_local uint32_t simIsrCalls;
+static thread_local voidFuncPtr simCallbacks[16];
+static thread_local bool simCoreInit;
+
+extern "C" void EIC_Handler(void);
+
+void simEicReset()
+{
+  simEic.CTRL.reg = 0;
+  simEic.STATUS.reg = 0;
+  simEic.INTFLAG.reg.value = 0;
+  simEic.CONFIG[0].reg = 0;
+  simEic.CONFIG[1].reg = 0;
+  simEicIntEn = 0;
+  simGclk.CLKCTRL.reg = 0;
+  simGclk.STATUS.reg = 0;
+  memset(simLevels, 0, sizeof(simLevels));
+  memset(simMuxed, 0, sizeof(simMuxed));
+  simNvicEnabled = false;
+  simIrqEnabled = true;
+  simInIsr = false;
+  simIsrCalls = 0;
+  memset(simCallbacks, 0, sizeof(simCallbacks));
+  simCoreInit = false;
+}
+
+/*
+ * Call EIC_Handler() while it has work, like the NVIC would
+ */
+static void service()
+{
+  while (!simInIsr && simIrqEnabled && simNvicEnabled && simEic.CTRL.bit.ENABLE &&
+         (simEic.INTFLAG.reg.value & simEicIntEn)) {
+    simInIsr = true;
+    ++simIsrCalls;
+    EIC_Handler();
+    simInIsr = false;
+  }
+}
+
+/*
+ * Detect an edge of a pin in the EIC
+ */
+static void edge(uint8_t pin, uint8_t level, bool glitch)
+{
+  int channel = g_APinDescription[pin].ulExtInt;
+  if (channel < 0 || channel >= 16 || !simMuxed[pin]) {
+    return;
+  }
+  uint32_t config = (simEic.CONFIG[channel / 8].reg >> ((channel % 8) * 4)) & 0xF;
+  if (glitch && (config & EIC_CONFIG_FILTEN0)) {
+    return;
+  }
+  uint32_t sense = config & 0x7;
+  if (sense == EIC_CONFIG_SENSE0_BOTH_Val ||
+      (sense == EIC_CONFIG_SENSE0_RISE_Val && level) ||
+      (sense == EIC_CONFIG_SENSE0_FALL_Val && !level)) {
+    simEic.INTFLAG.reg.value |= 1UL << channel;
+  }
+}
+
+void simEicSetPin(uint8_t pin, uint8_t level)
+{
+  if (pin >= PINS_COUNT || simLevels[pin] == !!level) {
+    return;
+  }
+  simLevels[pin] = !!level;
+  edge(pin, simLevels[pin], false);
+  service();
+}
+
+void simEicGlitch(uint8_t pin)
+{
+  if (pin >= PINS_COUNT) {
+    return;
+  }
+  uint8_t level = simLevels[pin];
+  edge(pin, !level, true);
+  edge(pin, level, true);
+  service();
+}
+
+uint32_t simEicIsrCount()
+{
+  return simIsrCalls;
+}
+
+bool simEicPinMuxed(uint8_t pin)
+{
+  return pin < PINS_COUNT && simMuxed[pin];
+}
+
+int pinPeripheral(uint32_t pin, EPioType type)
+{
+  if (pin >= PINS_COUNT) {
+    return -1;
+  }
+  simMuxed[pin] = type == PIO_EXTINT;
+  return 0;
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+  if (irq == EIC_IRQn) {
+    simNvicEnabled = true;
+  }
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+  if (irq == EIC_IRQn) {
+    simNvicEnabled = false;
+  }
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+  (void)irq;
+}
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+  (void)irq;
+  (void)priority;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+  return simIrqEnabled ? 0 : 1;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+  simIrqEnabled = !(primask & 1);
+  service();
+}
+
+void __disable_irq(void)
+{
+  simIrqEnabled = false;
+}
+
+void __enable_irq(void)
+{
+  simIrqEnabled = true;
+  service();
+}
+
+void pinMode(uint32_t pin, uint32_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+int digitalRead(uint32_t pin)
+{
+  return pin < PINS_COUNT ? simLevels[pin] : LOW;
+}
+
+/*
+ * The WInterrupts.c of the core: it clocks and enables the EIC on the
+ * first attachInterrupt(), only writes the SENSE bits of the channel,
+ * and its EIC_Handler() calls the callback of every channel whose flag
+ * is set, enabled or not
+ */
+extern "C" void attachInterrupt(uint32_t pin, voidFuncPtr callback, uint32_t mode)
+{
+  if (pin >= PINS_COUNT) {
+    return;
+  }
+  EExt_Interrupts channel = g_APinDescription[pin].ulExtInt;
+  if (channel == NOT_AN_INTERRUPT || channel == EXTERNAL_INT_NMI) {
+    return;
+  }
+  if (!simCoreInit) {
+    NVIC_EnableIRQ(EIC_IRQn);
+    simEic.CTRL.bit.ENABLE = 1;
+    simCoreInit = true;
+  }
+  pinPeripheral(pin, PIO_EXTINT);
+  simCallbacks[channel] = callback;
+  uint32_t sense;
+  switch (mode) {
+  case RISING:
+    sense = EIC_CONFIG_SENSE0_RISE_Val;
+    break;
+  case FALLING:
+    sense = EIC_CONFIG_SENSE0_FALL_Val;
+    break;
+  default:
+    sense = EIC_CONFIG_SENSE0_BOTH_Val;
+    break;
+  }
+  uint8_t pos = (channel % 8) * 4;
+  simEic.CONFIG[channel / 8].reg = (simEic.CONFIG[channel / 8].reg & ~(0x7UL << pos)) | (sense << pos);
+  simEic.INTENSET.reg = 1UL << channel;
+  service();
+}
+
+extern "C" void detachInterrupt(uint32_t pin)
+{
+  if (pin >= PINS_COUNT) {
+    return;
+  }
+  EExt_Interrupts channel = g_APinDescription[pin].ulExtInt;
+  if (channel == NOT_AN_INTERRUPT || channel == EXTERNAL_INT_NMI) {
+    return;
+  }
+  simEic.INTENCLR.reg = 1UL << channel;
+}
+
+extern "C" void EIC_Handler(void)
+{
+  for (uint8_t channel = 0; channel < 16; ++channel) {
+    if (simEic.INTFLAG.reg & (1UL << channel)) {
+      if (simCallbacks[channel]) {
+        simCallbacks[channel]();
+      }
+      simEic.INTFLAG.reg = 1UL << channel;
+    }
+  }
+}
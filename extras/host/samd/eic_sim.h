@@ -0,0 +1,36 @@
+/*
+ * eic_sim.h
+ *
+ * Host simulation of the SAMD21 External Interrupt Controller, for the
+ * SAMD backend of the PcInt library.  A level change of a pin whose
+ * channel senses that edge sets its INTFLAG bit, and EIC_Handler() is
+ * called while an enabled flag is set and interrupts are enabled.
+ *
+ * Like the AVR simulation the state is per thread.
+ *
+ * Build with PLATFORM=samd, e.g.
+ *   PLATFORM=samd extras/host/build.sh extras/host/samd/eic_demo.cpp /tmp/eic
+ */
+
+#ifndef EIC_SIM_H_
+#define EIC_SIM_H_
+
+#include <stdint.h>
+
+// Reset the EIC, the pins (all LOW) and the statistics
+void simEicReset();
+
+// Set the level of a pin
+void simEicSetPin(uint8_t pin, uint8_t level);
+
+// A pulse of one EIC clock on a pin, which the majority filter
+// (FILTEN) removes
+void simEicGlitch(uint8_t pin);
+
+// Number of EIC_Handler() calls since simEicReset()
+uint32_t simEicIsrCount();
+
+// The pin multiplexing set by pinPeripheral()
+bool simEicPinMuxed(uint8_t pin);
+
+#endif /* EIC_SIM_H_ */
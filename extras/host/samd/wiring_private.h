@@ -0,0 +1,20 @@
+/*
+ * wiring_private.h
+ *
+ * Host build of the SAMD21 backend: pin multiplexing.
+ */
+
+#ifndef HOST_SAMD_WIRING_PRIVATE_H_
+#define HOST_SAMD_WIRING_PRIVATE_H_
+
+#include <Arduino.h>
+
+typedef enum
+{
+  PIO_DIGITAL,
+  PIO_EXTINT,
+} EPioType;
+
+int pinPeripheral(uint32_t pin, EPioType type);
+
+#endif /* HOST_SAMD_WIRING_PRIVATE_H_ */
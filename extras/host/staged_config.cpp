@@ -0,0 +1,92 @@
+/*
+ * staged_config.cpp
+ *
+ * Host check of PCINT_STAGED_CONFIG: the changes that a handler makes
+ * to the configuration are done after the other handlers of the
+ * interrupt ran, in the order they were made, also when the queue
+ * overflows.
+ *
+ *   extras/host/build.sh extras/host/staged_config.cpp staged_config -DPCINT_STAGED_CONFIG
+ *   ./staged_config
+ */
+
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <Sodaq_PcInt.h>
+
+#include "pcint_sim.h"
+
+#if !defined(PCINT_STAGED_CONFIG)
+#error "Build with -DPCINT_STAGED_CONFIG"
+#endif
+#if !defined(PCINT_STAGED_SIZE)
+#define PCINT_STAGED_SIZE       4
+#endif
+
+static uint32_t callsA0;
+static uint32_t callsA1;
+static uint32_t callsA2;
+static int failures;
+
+static void handleA1() { ++callsA1; }
+static void handleA2() { ++callsA2; }
+static void handle9() {}
+
+// Changes A1, A2 and itself while A1 and A2 interrupt with it
+static void handleA0()
+{
+  ++callsA0;
+  PcInt::detachInterrupt(A1);
+  PcInt::attachInterrupt(A2, handleA2);
+  PcInt::disableInterrupt(A0);
+}
+
+// Attaches pin 9, fills the queue and detaches pin 9 again
+static void handleFill()
+{
+  PcInt::attachInterrupt(9, handle9);
+  for (uint8_t i = 0; i < PCINT_STAGED_SIZE; ++i) {
+    PcInt::enableInterrupt(8);
+  }
+  PcInt::detachInterrupt(9);
+}
+
+static void check(const char * what, uint32_t value, uint32_t expected)
+{
+  bool ok = value == expected;
+  printf("%-36s %6lu %6lu  %s\n", what, (unsigned long)value, (unsigned long)expected, ok ? "ok" : "FAIL");
+  if (!ok) {
+    ++failures;
+  }
+}
+
+int main()
+{
+  printf("%-36s %6s %6s\n", "", "value", "expect");
+
+  simReset();
+  PcInt::attachInterrupt(A0, handleA0);
+  PcInt::attachInterrupt(A1, handleA1);
+  // A0, A1 and A2 change in one interrupt: A1 still runs, A2 not yet
+  simSetPort(PC, 0x07);
+  check("A0, first interrupt", callsA0, 1);
+  check("A1 detached by A0, same interrupt", callsA1, 1);
+  check("A2 attached by A0, same interrupt", callsA2, 0);
+  // The changes are done now: A0 is disabled, A1 detached, A2 attached
+  check("A0 disabled", PCMSK1 & _BV(0), 0);
+  check("A1 detached", PcInt::getFunc(1, 1) != 0, 0);
+  check("A2 attached", PcInt::getFunc(1, 2) == handleA2, 1);
+  simSetPort(PC, 0x03);
+  check("A1 not called", callsA1, 1);
+  check("A2 called", callsA2, 1);
+
+  // More changes than the queue holds, the last one detaches pin 9
+  simReset();
+  PcInt::attachInterrupt(8, handleFill);
+  simSetPin(8, HIGH);
+  check("pin 9 detached after overflow", PcInt::getFunc(0, 1) != 0, 0);
+  check("pin 9 interrupt off", PCMSK0 & _BV(1), 0);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * static_handlers.cpp
+ *
+ * Host check of PCINT_STATIC_HANDLERS: the handlers declared with
+ * PCINT_HANDLER() are called for the edges of their mode only, and
+ * PcInt::begin() takes the levels after pinMode() as the reference, so
+ * a pull-up does not look like a rising edge.
+ *
+ *   extras/host/build.sh extras/host/static_handlers.cpp static_handlers -DPCINT_STATIC_HANDLERS
+ *   ./static_handlers
+ */
+
+#include <stdio.h>
+
+#include <Arduino.h>
+#include <Sodaq_PcInt.h>
+
+#include "pcint_sim.h"
+
+#if !defined(PCINT_STATIC_HANDLERS)
+#error "Build with -DPCINT_STATIC_HANDLERS"
+#endif
+
+static uint32_t rising;
+static uint32_t falling;
+static uint32_t changes;
+static uint32_t pullups;
+
+static void handleRising() { ++rising; }
+static void handleFalling() { ++falling; }
+static void handleChange() { ++changes; }
+static void handlePullup() { ++pullups; }
+
+PCINT_HANDLER(8, RISING, handleRising);
+PCINT_HANDLER(9, FALLING, handleFalling);
+PCINT_HANDLER(A0, CHANGE, handleChange);
+PCINT_HANDLER(4, RISING, handlePullup);
+
+static int failures;
+
+static void check(const char * what, uint32_t value, uint32_t expected)
+{
+  bool ok = value == expected;
+  printf("%-32s %6lu %6lu  %s\n", what, (unsigned long)value, (unsigned long)expected, ok ? "ok" : "FAIL");
+  if (!ok) {
+    ++failures;
+  }
+}
+
+int main()
+{
+  const uint32_t cycles = 100;
+
+  simReset();
+  simSetPin(8, LOW);
+  simSetPin(9, HIGH);
+  simSetPin(A0, LOW);
+  // Pin 4 floats low until setup() enables its pull-up, the simulator
+  // has no pull-ups so the level is set by hand
+  simSetPin(4, LOW);
+  pinMode(8, INPUT);
+  pinMode(9, INPUT);
+  pinMode(A0, INPUT);
+  pinMode(4, INPUT_PULLUP);
+  simSetPin(4, HIGH);
+  PcInt::begin();
+
+  printf("%-32s %6s %6s\n", "", "calls", "expect");
+  check("pull-up enabled before begin()", pullups, 0);
+
+  for (uint32_t i = 0; i < cycles; ++i) {
+    simSetPin(8, HIGH);
+    simSetPin(9, LOW);
+    simSetPin(A0, HIGH);
+    simAdvance(100);
+    simSetPin(8, LOW);
+    simSetPin(9, HIGH);
+    simSetPin(A0, LOW);
+    simAdvance(100);
+  }
+  check("RISING, per cycle", rising, cycles);
+  check("FALLING, per cycle", falling, cycles);
+  check("CHANGE, per cycle", changes, 2 * cycles);
+
+  // Edges of the other pins of a group do not call a handler
+  rising = 0;
+  falling = 0;
+  for (uint32_t i = 0; i < cycles; ++i) {
+    simSetPin(10, HIGH);
+    simAdvance(100);
+    simSetPin(10, LOW);
+    simAdvance(100);
+  }
+  check("other pin of the group", rising + falling, 0);
+
+  simSetPin(4, LOW);
+  simSetPin(4, HIGH);
+  check("RISING after the pull-up", pullups, 1);
+
+  return failures ? 1 : 0;
+}
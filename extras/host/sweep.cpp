@@ -0,0 +1,253 @@
+/*
+ * sweep.cpp
+ *
+ * Monte-Carlo sweep of debounce and glitch filter settings.  For every
+ * point of the parameter grid, many noisy synthetic button traces
+ * (contact bounce, burst noise, jitter) are played through the library's
+ * dispatch path, with the filter installed as a PcInt group filter.  The
+ * accepted edges are compared with the clean signal:
+ *
+ *   false accept  accepted edges that do not match a real edge
+ *   false reject  real edges without an accepted edge
+ *   cost          simulated CPU cycles per real edge: the pin change
+ *                 ISRs with the filter, and the timer checks
+ *
+ * The filter (in the pin change ISR) only notes the time of the raw
+ * change and arms a timer check.  The check accepts the level of the
+ * pin when
+ *   - it has not changed for GLITCH us (glitch filter), and
+ *   - the previous accepted change is at least LOCKOUT us ago
+ *     (debounce), and
+ *   - it differs from the accepted level.
+ * A check that finds the lockout still running is done again when the
+ * lockout ends, so the accepted level always follows the pin.
+ *
+ * The work is spread over all cores.  Build it with PCINT_FILTERS:
+ *   extras/host/build.sh extras/host/sweep.cpp sweep -DPCINT_FILTERS
+ *
+ * usage: sweep [-n TRACES] [-t THREADS]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <Arduino.h>
+#include <Sodaq_PcInt.h>
+
+#include "pcint_sim.h"
+#include "pcint_wave.h"
+
+#if !defined(PCINT_FILTERS)
+#error "Build the sweep with -DPCINT_FILTERS"
+#endif
+
+#define PIN             A0
+#define PRESSES         10
+#define PERIOD          200000UL        // us between presses
+#define MATCH           20000UL         // an accepted edge must follow a real edge within this
+
+// Simulated cost, in CPU cycles
+#define ISR_CYCLES      40              // interrupt response, prologue and epilogue
+#define FILTER_CYCLES   60              // the filter, arming the timer
+#define CHECK_CYCLES    80              // a timer check, with its ISR overhead
+
+static const uint32_t lockouts[] = { 0, 500, 1000, 2000, 5000, 10000 };
+static const uint32_t glitches[] = { 0, 10, 20, 50, 100 };
+#define NR_LOCKOUTS     (sizeof(lockouts) / sizeof(lockouts[0]))
+#define NR_GLITCHES     (sizeof(glitches) / sizeof(glitches[0]))
+
+// Per board (thread) state of the filter and the handler
+static thread_local uint32_t lockout;
+static thread_local uint32_t glitch;
+static thread_local uint32_t lastAccepted;
+static thread_local uint32_t lastRaw;
+static thread_local uint8_t acceptedLevel;
+static thread_local uint64_t busyCycles;
+static thread_local std::vector<uint32_t> * accepted;
+
+static void check(void * arg);
+
+/*
+ * Arm a check at the given time, or do it now if that has passed
+ */
+static void armCheck(uint32_t time)
+{
+  if ((int32_t)(time - simTime()) <= 0) {
+    check(0);
+  } else {
+    simSchedule(time, check, 0);
+  }
+}
+
+static void check(void *)
+{
+  simConsume(CHECK_CYCLES);
+  busyCycles += CHECK_CYCLES;
+  uint32_t now = simTime();
+  if (now - lastRaw < glitch) {
+    return;                     // changed again, the next check decides
+  }
+  uint8_t level = (PcInt::getState(digitalPinToPCICRbit(PIN)) & digitalPinToBitMask(PIN)) ? HIGH : LOW;
+  if (level == acceptedLevel) {
+    return;
+  }
+  if (now - lastAccepted < lockout) {
+    armCheck(lastAccepted + lockout);
+    return;
+  }
+  lastAccepted = now;
+  acceptedLevel = level;
+  accepted->push_back(now);
+}
+
+static uint8_t filter(uint8_t group, uint8_t changed)
+{
+  (void)group;
+  uint8_t bit = digitalPinToBitMask(PIN);
+  if (!(changed & bit)) {
+    return changed;
+  }
+  simConsume(FILTER_CYCLES);
+  busyCycles += FILTER_CYCLES;
+  lastRaw = micros();
+  armCheck(lastRaw + glitch);
+  // The handler is not used, the checks record the accepted edges
+  return changed & ~bit;
+}
+
+static void handleEdge()
+{
+}
+
+struct Score
+{
+  uint64_t edges;
+  uint64_t falseAccepts;
+  uint64_t falseRejects;
+  uint64_t cycles;
+};
+
+/*
+ * Simulate one noisy trace with the given settings
+ */
+static void runTrace(uint32_t seed, uint32_t lockoutUs, uint32_t glitchUs, Score & score)
+{
+  simReset();
+  lockout = lockoutUs;
+  glitch = glitchUs;
+  lastAccepted = 0;
+  lastRaw = 0;
+  acceptedLevel = HIGH;
+  busyCycles = 0;
+  std::vector<uint32_t> edges;
+  accepted = &edges;
+
+  pinMode(PIN, INPUT);
+  simSetIsrCycles(ISR_CYCLES);
+  simSetPin(PIN, HIGH);
+  PcInt::attachInterrupt(PIN, handleEdge);
+  PcInt::setFilter(digitalPinToPCICRbit(PIN), filter);
+  simAdvance(PERIOD / 2);
+  uint32_t isrsBefore = simIsrCount(digitalPinToPCICRbit(PIN));
+  busyCycles = 0;
+
+  // The real edges: press and release, PERIOD / 2 apart
+  std::vector<uint32_t> real;
+  uint32_t start = simTime() + PERIOD / 2;
+  for (uint32_t i = 0; i < PRESSES; ++i) {
+    real.push_back(start + i * PERIOD);
+    real.push_back(start + i * PERIOD + PERIOD / 2);
+  }
+
+  SimWave wave(seed);
+  wave.button(PIN, start, PERIOD, PRESSES, 1 + seed % 6, 500 + seed % 3000);
+  wave.burst(PIN, start, PRESSES * PERIOD, 1 + seed % 5, 3, 30);
+  wave.jitter(5.0);
+  simPlay(wave);
+  simAdvance(PERIOD);
+
+  // Match the accepted edges to the real ones, in order
+  size_t a = 0;
+  uint64_t matched = 0;
+  for (size_t r = 0; r < real.size(); ++r) {
+    while (a < edges.size() && edges[a] + 100 < real[r]) {
+      ++a;                      // accepted before this real edge
+    }
+    if (a < edges.size() && edges[a] < real[r] + MATCH) {
+      ++matched;
+      ++a;
+    }
+  }
+  score.edges += real.size();
+  score.falseAccepts += edges.size() - matched;
+  score.falseRejects += real.size() - matched;
+  score.cycles += busyCycles + (uint64_t)(simIsrCount(digitalPinToPCICRbit(PIN)) - isrsBefore) * ISR_CYCLES;
+}
+
+static double seconds()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char * argv[])
+{
+  uint32_t traces = 1000;
+  uint32_t threads = std::thread::hardware_concurrency();
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "-n") == 0) {
+      traces = atoi(argv[i + 1]);
+    } else if (strcmp(argv[i], "-t") == 0) {
+      threads = atoi(argv[i + 1]);
+    }
+  }
+  if (threads == 0) {
+    threads = 1;
+  }
+
+  // One job per setting, each thread keeps its own scores
+  const uint32_t settings = NR_LOCKOUTS * NR_GLITCHES;
+  std::vector<std::vector<Score> > scores(threads, std::vector<Score>(settings, Score()));
+  std::atomic<uint64_t> next(0);
+  std::vector<std::thread> pool;
+  double start = seconds();
+  for (uint32_t t = 0; t < threads; ++t) {
+    pool.push_back(std::thread([&, t]() {
+      uint64_t job;
+      while ((job = next++) < (uint64_t)settings * traces) {
+        uint32_t setting = job / traces;
+        runTrace(job % traces + 1, lockouts[setting / NR_GLITCHES],
+                 glitches[setting % NR_GLITCHES], scores[t][setting]);
+      }
+    }));
+  }
+  for (size_t t = 0; t < pool.size(); ++t) {
+    pool[t].join();
+  }
+  double elapsed = seconds() - start;
+
+  printf("%8s %8s %12s %12s %12s\n", "lockout", "glitch", "false acc %", "false rej %", "cycles/edge");
+  for (uint32_t s = 0; s < settings; ++s) {
+    Score total = Score();
+    for (uint32_t t = 0; t < threads; ++t) {
+      total.edges += scores[t][s].edges;
+      total.falseAccepts += scores[t][s].falseAccepts;
+      total.falseRejects += scores[t][s].falseRejects;
+      total.cycles += scores[t][s].cycles;
+    }
+    printf("%8lu %8lu %12.2f %12.2f %12.1f\n",
+           (unsigned long)lockouts[s / NR_GLITCHES], (unsigned long)glitches[s % NR_GLITCHES],
+           100.0 * total.falseAccepts / total.edges, 100.0 * total.falseRejects / total.edges,
+           (double)total.cycles / total.edges);
+  }
+  printf("%lu traces per setting, %lu settings, %lu threads, %.2f s\n",
+         (unsigned long)traces, (unsigned long)settings, (unsigned long)threads, elapsed);
+  return 0;
+}
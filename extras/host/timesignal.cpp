@@ -0,0 +1,255 @@
+/*
+ * timesignal.cpp
+ *
+ * Host check of PcIntTimeSignal.  It plays DCF77 and WWVB minutes into
+ * a simulated pin (valid ones, one with a bad parity or digit, and one
+ * with a short glitch in a pulse) and checks what read() gives after
+ * each of them.  DCF77 is played with both receiver polarities.  With
+ * PCINT_DEFERRED the loop calls dispatchPending() every 20 ms, and the
+ * glitch falls between two calls: the handler does not see it.
+ *
+ *   extras/host/build.sh extras/host/timesignal.cpp timesignal -DPCINT_TIMESTAMPS
+ *   extras/host/build.sh extras/host/timesignal.cpp timesignal "-DPCINT_TIMESTAMPS -DPCINT_DEFERRED"
+ *   ./timesignal
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <Arduino.h>
+#include <Sodaq_PcInt.h>
+#include <Sodaq_PcInt_timesignal.h>
+
+#include "pcint_sim.h"
+
+#define PIN             A0
+#define SECOND          1000000UL
+#define MINUTE          (60 * SECOND)
+#define START           SECOND
+#define LOOP_PERIOD     20000UL
+
+#if defined(PCINT_DEFERRED)
+#define GLITCH_SEEN     false
+#else
+#define GLITCH_SEEN     true
+#endif
+
+static bool inverted;
+static int failures;
+
+static void setLevel(void * arg)
+{
+  simSetPin(PIN, (arg != 0) != inverted);
+}
+
+static void pulse(uint32_t time, uint32_t ms)
+{
+  simSchedule(time, setLevel, (void *)1);
+  simSchedule(time + ms * 1000, setLevel, 0);
+}
+
+#if defined(PCINT_DEFERRED)
+static void loopPass(void *)
+{
+  PcInt::dispatchPending();
+  simSchedule(simTime() + LOOP_PERIOD, loopPass, 0);
+}
+#endif
+
+// A dip of 2 ms, 50 ms into the pulse of the second that starts at time
+static void glitch(uint32_t time)
+{
+  simSchedule(time + 50000UL, setLevel, 0);
+  simSchedule(time + 52000UL, setLevel, (void *)1);
+}
+
+static void setLsb(uint8_t * bits, int first, int count, int value)
+{
+  for (int i = 0; i < count; ++i) {
+    bits[first + i] = (value >> i) & 1;
+  }
+}
+
+static void setMsb(uint8_t * bits, int first, int count, int value)
+{
+  for (int i = 0; i < count; ++i) {
+    bits[first + i] = (value >> (count - 1 - i)) & 1;
+  }
+}
+
+static uint8_t parity(const uint8_t * bits, int first, int last)
+{
+  uint8_t odd = 0;
+  for (int i = first; i <= last; ++i) {
+    odd ^= bits[i];
+  }
+  return odd;
+}
+
+/*
+ * The DCF77 seconds 0..58 that describe the minute starting at
+ * time + 60 s, CEST.  flip inverts one bit, glitchAt puts a glitch in a
+ * second.
+ */
+static void dcf77(uint32_t time, int year, int month, int day, int weekday, int hour, int minute,
+                  int flip = -1, int glitchAt = -1)
+{
+  uint8_t bits[59] = { 0 };
+  bits[17] = 1;
+  bits[20] = 1;
+  setLsb(bits, 21, 4, minute % 10);
+  setLsb(bits, 25, 3, minute / 10);
+  bits[28] = parity(bits, 21, 27);
+  setLsb(bits, 29, 4, hour % 10);
+  setLsb(bits, 33, 2, hour / 10);
+  bits[35] = parity(bits, 29, 34);
+  setLsb(bits, 36, 4, day % 10);
+  setLsb(bits, 40, 2, day / 10);
+  setLsb(bits, 42, 3, weekday);
+  setLsb(bits, 45, 4, month % 10);
+  setLsb(bits, 49, 1, month / 10);
+  setLsb(bits, 50, 4, year % 10);
+  setLsb(bits, 54, 4, year / 10);
+  bits[58] = parity(bits, 36, 57);
+  if (flip >= 0) {
+    bits[flip] ^= 1;
+  }
+  for (int s = 0; s < 59; ++s) {
+    pulse(time + s * SECOND, bits[s] ? 200 : 100);
+    if (s == glitchAt) {
+      glitch(time + s * SECOND);
+    }
+  }
+}
+
+/*
+ * The WWVB seconds 0..59 of the minute starting at time, DST in effect.
+ * badDigit sends 12 as the minute units.
+ */
+static void wwvb(uint32_t time, int year, int dayOfYear, int hour, int minute, bool leap,
+                 bool badDigit = false, int glitchAt = -1)
+{
+  uint8_t bits[60] = { 0 };
+  setMsb(bits, 1, 3, minute / 10);
+  setMsb(bits, 5, 4, badDigit ? 12 : minute % 10);
+  setMsb(bits, 12, 2, hour / 10);
+  setMsb(bits, 15, 4, hour % 10);
+  setMsb(bits, 22, 2, dayOfYear / 100);
+  setMsb(bits, 25, 4, dayOfYear / 10 % 10);
+  setMsb(bits, 30, 4, dayOfYear % 10);
+  setMsb(bits, 45, 4, year / 10);
+  setMsb(bits, 50, 4, year % 10);
+  bits[55] = leap;
+  bits[57] = 1;
+  bits[58] = 1;
+  for (int s = 0; s < 60; ++s) {
+    bool marker = s == 0 || s % 10 == 9;
+    pulse(time + s * SECOND, marker ? 800 : bits[s] ? 500 : 200);
+    if (s == glitchAt) {
+      glitch(time + s * SECOND);
+    }
+  }
+}
+
+/*
+ * Run until time and check read(): whether a new minute is available,
+ * the minute (as 20yy-mm-dd wd hh:mm, stamp) and the error count
+ */
+static void check(const char * what, uint32_t time, bool available, const char * expected,
+                  uint32_t stamp, uint16_t errors)
+{
+  simRunUntil(time);
+  bool avail = PcIntTimeSignal::available();
+  PcIntTime t;
+  char got[40] = "none";
+  uint32_t gotStamp = 0;
+  if (PcIntTimeSignal::read(t)) {
+    snprintf(got, sizeof(got), "20%02u-%02u-%02u %u %02u:%02u", t.year, t.month, t.day, t.weekday,
+             t.hour, t.minute);
+    gotStamp = t.stamp;
+  }
+  uint16_t errs = PcIntTimeSignal::getErrors();
+  bool ok = avail == available && strcmp(got, expected) == 0 && gotStamp == stamp && errs == errors;
+  printf("%-28s %-5s %-22s %10lu %3u  %s\n", what, avail ? "new" : "old", got,
+         (unsigned long)gotStamp, errs, ok ? "ok" : "FAIL");
+  if (!ok) {
+    ++failures;
+  }
+}
+
+static void runDcf77(bool inv)
+{
+  inverted = inv;
+  simReset();
+  simSetPin(PIN, inverted);
+  PcIntTimeSignal::begin(PIN, PcIntTimeSignal::DCF77, inverted);
+#if defined(PCINT_DEFERRED)
+  loopPass(0);
+#endif
+  printf("DCF77%s\n", inverted ? ", inverted" : "");
+
+  // The first minute mark gives sync, so minute 0 is not decoded
+  dcf77(START, 26, 10, 18, 7, 14, 31);
+  dcf77(START + MINUTE, 26, 10, 18, 7, 14, 32);
+  dcf77(START + 2 * MINUTE, 26, 10, 18, 7, 14, 33, 30);
+  dcf77(START + 3 * MINUTE, 26, 10, 18, 7, 14, 34);
+  dcf77(START + 4 * MINUTE, 26, 10, 18, 7, 14, 35, -1, 10);
+  dcf77(START + 5 * MINUTE, 26, 10, 18, 7, 14, 36);
+  dcf77(START + 6 * MINUTE, 26, 10, 18, 7, 14, 37);
+  pulse(START + 7 * MINUTE, 100);
+
+  check("before sync", START + MINUTE + SECOND, false, "none", 0, 0);
+  check("valid", START + 2 * MINUTE + SECOND, true, "2026-10-18 7 14:32", START + 2 * MINUTE, 0);
+  check("bad parity", START + 3 * MINUTE + SECOND, false, "2026-10-18 7 14:32", START + 2 * MINUTE, 1);
+  check("valid", START + 4 * MINUTE + SECOND, true, "2026-10-18 7 14:34", START + 4 * MINUTE, 1);
+  // The glitch loses 14:35, the minute mark after it gives sync again
+  if (GLITCH_SEEN) {
+    check("glitch", START + 5 * MINUTE + SECOND, false, "2026-10-18 7 14:34", START + 4 * MINUTE, 2);
+  } else {
+    check("glitch", START + 5 * MINUTE + SECOND, true, "2026-10-18 7 14:35", START + 5 * MINUTE, 1);
+  }
+  uint16_t errors = GLITCH_SEEN ? 2 : 1;
+  check("resync", START + 6 * MINUTE + SECOND, true, "2026-10-18 7 14:36", START + 6 * MINUTE, errors);
+  check("valid", START + 7 * MINUTE + SECOND, true, "2026-10-18 7 14:37", START + 7 * MINUTE, errors);
+}
+
+static void runWwvb()
+{
+  inverted = false;
+  simReset();
+  PcIntTimeSignal::begin(PIN, PcIntTimeSignal::WWVB);
+#if defined(PCINT_DEFERRED)
+  loopPass(0);
+#endif
+  printf("WWVB\n");
+
+  // The double marker at the start of minute 1 gives sync.  Day 61 of
+  // the leap year 2024 is March 1.
+  wwvb(START, 24, 60, 23, 59, true);
+  wwvb(START + MINUTE, 24, 61, 0, 0, true);
+  wwvb(START + 2 * MINUTE, 24, 61, 0, 1, true, true);
+  wwvb(START + 3 * MINUTE, 24, 61, 0, 2, true);
+  wwvb(START + 4 * MINUTE, 24, 61, 0, 3, true, false, 10);
+  wwvb(START + 5 * MINUTE, 24, 366, 0, 4, true);
+
+  check("before sync", START + MINUTE + SECOND, false, "none", 0, 0);
+  check("valid", START + 2 * MINUTE, true, "2024-03-01 0 00:00", START + MINUTE, 0);
+  check("bad digit", START + 3 * MINUTE, false, "2024-03-01 0 00:00", START + MINUTE, 1);
+  check("valid", START + 4 * MINUTE, true, "2024-03-01 0 00:02", START + 3 * MINUTE, 1);
+  // The glitch loses sync, the double marker of the next minute gets it
+  if (GLITCH_SEEN) {
+    check("glitch", START + 5 * MINUTE, false, "2024-03-01 0 00:02", START + 3 * MINUTE, 2);
+  } else {
+    check("glitch", START + 5 * MINUTE, true, "2024-03-01 0 00:03", START + 4 * MINUTE, 1);
+  }
+  check("valid", START + 6 * MINUTE, true, "2024-12-31 0 00:04", START + 5 * MINUTE, GLITCH_SEEN ? 2 : 1);
+}
+
+int main()
+{
+  printf("%-28s %-5s %-22s %10s %3s\n", "", "read", "minute", "stamp", "err");
+  runDcf77(false);
+  runDcf77(true);
+  runWwvb();
+  return failures ? 1 : 0;
+}
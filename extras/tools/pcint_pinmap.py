@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+#
+# pcint_pinmap.py
+#
+# Generate the constexpr pin change interrupt pin map of a board variant
+# for src/Sodaq_PcInt_pins.h.
+#
+# Copyright (c) 2014 Kees Bakker
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# The variant's pins_arduino.h is compiled on the host, together with a
+# stub of the MCU's registers, and the digitalPinToPCICR(),
+# digitalPinToPCMSK(), digitalPinToPCMSKbit(), digitalPinToBitMask() and
+# portInputRegister() macros are evaluated for every pin.  So the table
+# is exactly what the core itself uses at run time.
+#
+# The group of a pin (the PCINTn_vect that serves it) is the number of
+# its PCMSK register.  It is not always its PCICR bit: the PCIE bits of
+# the ATtiny GIMSK are 4 and 5.
+#
+# The registers are placed in a 64K aligned array, so that the low 16
+# bits of their host address are their AVR data address.  The
+# (uint16_t) &PINB casts of the variant need -fpermissive for that.
+#
+# Usage:
+#   pcint_pinmap.py --mcu atmega328p ~/.arduino15/packages/arduino/hardware/avr/1.8.6/variants/standard
+#   pcint_pinmap.py --mcu atmega1284p --guard 'defined(ARDUINO_AVR_SODAQ_MBILI)' .../variants/mbili
+
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# Data address of the PIN register of each port (DDR is +1, PORT +2)
+PORTS = {
+    'atmega328p': {'B': 0x23, 'C': 0x26, 'D': 0x29},
+    'atmega1284p': {'A': 0x20, 'B': 0x23, 'C': 0x26, 'D': 0x29},
+    'atmega2560': {'A': 0x20, 'B': 0x23, 'C': 0x26, 'D': 0x29, 'E': 0x2C,
+                   'F': 0x2F, 'G': 0x32, 'H': 0x100, 'J': 0x103, 'K': 0x106,
+                   'L': 0x109},
+    'attiny84': {'A': 0x39, 'B': 0x36},
+    'attiny85': {'B': 0x36},
+}
+
+# Data address of the interrupt control and mask registers
+REGISTERS = {
+    'atmega328p': {'PCICR': 0x68, 'PCMSK0': 0x6B, 'PCMSK1': 0x6C, 'PCMSK2': 0x6D},
+    'atmega1284p': {'PCICR': 0x68, 'PCMSK0': 0x6B, 'PCMSK1': 0x6C, 'PCMSK2': 0x6D,
+                    'PCMSK3': 0x73},
+    'atmega2560': {'PCICR': 0x68, 'PCMSK0': 0x6B, 'PCMSK1': 0x6C, 'PCMSK2': 0x6D},
+    'attiny84': {'GIMSK': 0x5B, 'PCMSK0': 0x32, 'PCMSK1': 0x40},
+    'attiny85': {'GIMSK': 0x5B, 'PCMSK': 0x35},
+}
+
+# The compiler's define of the MCU, the default guard of the table
+MCU_DEFINES = {
+    'atmega328p': '__AVR_ATmega328P__',
+    'atmega1284p': '__AVR_ATmega1284P__',
+    'atmega2560': '__AVR_ATmega2560__',
+    'attiny84': '__AVR_ATtiny84__',
+    'attiny85': '__AVR_ATtiny85__',
+}
+
+STUB = r'''
+#include <stdint.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define pgm_read_byte(p)        (*(const uint8_t *)(p))
+#define pgm_read_word(p)        (*(const uint16_t *)(p))
+#define _BV(bit)                (1 << (bit))
+
+#define NOT_A_PIN       0
+#define NOT_A_PORT      0
+#define PA 1
+#define PB 2
+#define PC 3
+#define PD 4
+#define PE 5
+#define PF 6
+#define PG 7
+#define PH 8
+#define PJ 10
+#define PK 11
+#define PL 12
+
+#define NOT_ON_TIMER 0
+enum { TIMER0A = 1, TIMER0B, TIMER1A, TIMER1B, TIMER1C, TIMER2, TIMER2A, TIMER2B,
+       TIMER3A, TIMER3B, TIMER3C, TIMER4A, TIMER4B, TIMER4C, TIMER4D,
+       TIMER5A, TIMER5B, TIMER5C };
+
+alignas(0x10000) static volatile uint8_t mem[0x10000];
+#define ADDR(p)         ((unsigned)((uintptr_t)(p) - (uintptr_t)mem))
+
+%(registers)s
+
+#define ARDUINO_MAIN
+#include <pins_arduino.h>
+
+#define digitalPinToPort(P)     (pgm_read_byte(digital_pin_to_port_PGM + (P)))
+#define digitalPinToBitMask(P)  (pgm_read_byte(digital_pin_to_bit_mask_PGM + (P)))
+
+int main()
+{
+  for (unsigned pin = 0; pin < NUM_DIGITAL_PINS; ++pin) {
+    volatile uint8_t * pcicr = digitalPinToPCICR(pin);
+    volatile uint8_t * pcmsk = digitalPinToPCMSK(pin);
+    if (!pcicr || !pcmsk) {
+      printf("%%u -\n", pin);
+      continue;
+    }
+    printf("%%u %%u %%u %%u %%u %%u %%u\n", pin, (unsigned)digitalPinToPCICRbit(pin),
+           (unsigned)digitalPinToPCMSKbit(pin), (unsigned)digitalPinToBitMask(pin),
+           ADDR(pcicr), ADDR(pcmsk),
+           (unsigned)(pgm_read_word(port_to_input_PGM + digitalPinToPort(pin)) & 0xFFFF));
+  }
+  return 0;
+}
+'''
+
+
+def registers(mcu):
+    regs = dict(REGISTERS[mcu])
+    for port, pin in PORTS[mcu].items():
+        regs['PIN' + port] = pin
+        regs['DDR' + port] = pin + 1
+        regs['PORT' + port] = pin + 2
+    lines = ['#define %s mem[0x%X]' % (name, addr) for name, addr in sorted(regs.items())]
+    lines.append('#define %s' % MCU_DEFINES[mcu])
+    return '\n'.join(lines)
+
+
+def evaluate(args):
+    tmp = tempfile.mkdtemp(prefix='pcint-pinmap.')
+    try:
+        os.mkdir(os.path.join(tmp, 'avr'))
+        # The variant includes avr/pgmspace.h, the stub already has it
+        open(os.path.join(tmp, 'avr', 'pgmspace.h'), 'w').close()
+        src = os.path.join(tmp, 'pinmap.cpp')
+        with open(src, 'w') as f:
+            f.write(STUB % {'registers': registers(args.mcu)})
+        exe = os.path.join(tmp, 'pinmap')
+        subprocess.check_call([args.cxx, '-std=gnu++11', '-fpermissive', '-w',
+                               '-I', tmp, '-I', args.variant, '-o', exe, src])
+        out = subprocess.check_output([exe]).decode()
+    finally:
+        shutil.rmtree(tmp)
+    pcmsks = dict((addr, name) for name, addr in REGISTERS[args.mcu].items()
+                  if name.startswith('PCMSK'))
+    rows = []
+    for line in out.splitlines():
+        f = line.split()
+        if f[1] == '-':
+            rows.append((int(f[0]), None))
+            continue
+        pcie, pcmskBit, mask, pcicr, pcmsk, port = [int(x) for x in f[1:]]
+        group = int(pcmsks[pcmsk][5:] or 0)
+        rows.append((int(f[0]), [group, pcie, pcmskBit, mask, pcicr, pcmsk, port]))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the PCINT pin map of a variant')
+    parser.add_argument('variant', help='directory with the pins_arduino.h of the variant')
+    parser.add_argument('--mcu', required=True, help='e.g. atmega328p')
+    parser.add_argument('--guard', help='preprocessor condition of the table, '
+                        'default the MCU define')
+    parser.add_argument('--cxx', default='g++')
+    args = parser.parse_args()
+
+    if args.mcu not in PORTS:
+        sys.exit('Unknown MCU %s, known: %s' % (args.mcu, ' '.join(sorted(PORTS))))
+    guard = args.guard or 'defined(%s)' % MCU_DEFINES[args.mcu]
+
+    print('#elif %s' % guard)
+    print('/* pcint_pinmap.py --mcu %s %s */' % (args.mcu, os.path.basename(os.path.normpath(args.variant))))
+    print('#define PCINT_PIN_TABLE')
+    print('static constexpr PcIntPin pcintPins[] = {')
+    for pin, row in evaluate(args):
+        if row is None:
+            print('  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },%*s// %d' % (7, '', pin))
+        else:
+            print('  { %d, %d, %d, 0x%02X, 0x%02X, 0x%02X, 0x%03X },%*s// %d'
+                  % (tuple(row) + (7, '', pin)))
+    print('};')
+
+
+if __name__ == '__main__':
+    main()
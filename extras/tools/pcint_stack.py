@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+#
+# pcint_stack.py
+#
+# Maximum stack depth of the PCINT ISRs.
+#
+# Copyright (c) 2014 Kees Bakker
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# The frame size of each function is taken from the .su files written
+# by gcc -fstack-usage.  For AVR that size includes the return address
+# and the saved registers, so for an ISR it includes the complete register
+# save frame.  Functions without a .su entry (libgcc, assembler) are
+# estimated from their push instructions and frame allocation, but the
+# ISRs must have one: without .su files, or with files from a build with
+# -flto, the tool stops with an error.  Build without LTO.  The call
+# graph comes from avr-objdump -d -C.  Indirect calls (the user handlers)
+# are charged with the deepest of the functions given with --handler.
+#
+# With --nested the depths of all PCINT ISRs are added up, which is the
+# worst case when the ISRs are non-blocking (ISR_NOBLOCK).  With --limit
+# the exit status is 1 when the depth exceeds the limit.
+#
+# Usage:
+#   pcint_stack.py --mcu atmega328p --su-dir build sketch.elf --handler handleA0
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from pcint_wcet import PCINT_VECTORS, PC22, LABEL_RE, LINE_RE, TARGET_RE
+
+
+def base_name(decl):
+    """'static void PcInt::attach(uint8_t)' -> 'PcInt::attach'"""
+    decl = decl.split('(')[0].strip()
+    return decl.split()[-1] if decl else decl
+
+
+def read_su(su_dir):
+    sizes = {}
+    for root, _, files in os.walk(su_dir):
+        for fn in files:
+            if not fn.endswith('.su'):
+                continue
+            with open(os.path.join(root, fn)) as f:
+                for line in f:
+                    parts = line.rstrip('\n').split('\t')
+                    if len(parts) < 2:
+                        continue
+                    name = base_name(parts[0].split(':', 3)[-1])
+                    sizes[name] = max(sizes.get(name, 0), int(parts[1]))
+    return sizes
+
+
+def read_functions(args):
+    if args.input.endswith('.elf'):
+        out = subprocess.check_output([args.objdump, '-d', '-C', args.input])
+        lines = out.decode('utf-8', 'replace').splitlines()
+    else:
+        with open(args.input) as f:
+            lines = f.read().splitlines()
+    funcs = {}
+    addrs = {}
+    name = None
+    for line in lines:
+        m = LABEL_RE.match(line.strip())
+        if m:
+            name = base_name(m.group(2))
+            addrs[int(m.group(1), 16)] = name
+            funcs.setdefault(name, [])
+            continue
+        m = LINE_RE.match(line)
+        if m and name:
+            funcs[name].append((m.group(3), m.group(4)))
+    return funcs, addrs
+
+
+def estimate_frame(insns, ret_size):
+    """Frame size from the prologue: pushes and 'sbiw r28, N'"""
+    size = ret_size
+    for op, operands in insns:
+        if op == 'push':
+            size += 1
+        elif op in ('sbiw', 'subi') and operands.startswith('r28'):
+            m = re.search(r'0x([0-9a-fA-F]+)|(\d+)\s*$', operands)
+            if m:
+                size += int(m.group(1), 16) if m.group(1) else int(m.group(2))
+    return size
+
+
+class StackAnalyser(object):
+    def __init__(self, funcs, addrs, sizes, ret_size, handlers):
+        self.funcs = funcs
+        self.addrs = addrs
+        self.sizes = sizes
+        self.ret_size = ret_size
+        self.handlers = handlers
+        self.cache = {}
+        self.active = set()
+        self.warnings = []
+
+    def frame(self, name):
+        if name in self.sizes:
+            return self.sizes[name]
+        self.warnings.append('no stack usage for %s, estimated' % name)
+        return estimate_frame(self.funcs.get(name, []), self.ret_size)
+
+    def depth(self, name):
+        if name in self.cache:
+            return self.cache[name]
+        if name in self.active:
+            self.warnings.append('recursion through %s not bounded' % name)
+            return 0
+        self.active.add(name)
+        deepest = 0
+        for op, operands in self.funcs.get(name, []):
+            if op in ('call', 'rcall'):
+                m = TARGET_RE.search(operands) or re.match(r'0x([0-9a-f]+)', operands)
+                target = self.addrs.get(int(m.group(1), 16)) if m else None
+                if target and target != name:
+                    deepest = max(deepest, self.depth(target))
+            elif op in ('icall', 'eicall'):
+                if not self.handlers:
+                    self.warnings.append('%s has indirect calls, use --handler' % name)
+                for h in self.handlers:
+                    deepest = max(deepest, self.depth(h))
+        self.active.discard(name)
+        self.cache[name] = self.frame(name) + deepest
+        return self.cache[name]
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Maximum stack depth of the PCINT ISRs')
+    parser.add_argument('input', help='ELF file (.elf) or avr-objdump -d -C listing')
+    parser.add_argument('--mcu', required=True, help='e.g. atmega328p')
+    parser.add_argument('--su-dir', required=True, help='directory with the .su files')
+    parser.add_argument('--handler', action='append', default=[],
+                        help='name of a user handler, can be repeated')
+    parser.add_argument('--nested', action='store_true',
+                        help='add up the depths of all PCINT ISRs')
+    parser.add_argument('--limit', type=int, default=0,
+                        help='fail when the depth exceeds this number of bytes')
+    parser.add_argument('--objdump', default='avr-objdump')
+    args = parser.parse_args()
+
+    if args.mcu not in PCINT_VECTORS:
+        sys.exit('Unknown MCU %s, known: %s' % (args.mcu, ' '.join(sorted(PCINT_VECTORS))))
+    funcs, addrs = read_functions(args)
+    sizes = read_su(args.su_dir)
+    if not sizes:
+        sys.exit('ERROR: no stack usage in %s, build with -fstack-usage -fno-lto' % args.su_dir)
+    a = StackAnalyser(funcs, addrs, sizes, 3 if args.mcu in PC22 else 2, args.handler)
+
+    total = 0
+    worst = 0
+    print('%-8s %-12s %8s' % ('group', 'vector', 'bytes'))
+    for group, vector in enumerate(PCINT_VECTORS[args.mcu]):
+        name = '__vector_%d' % vector
+        if name not in funcs:
+            continue
+        if name not in sizes:
+            sys.exit('ERROR: no stack usage for %s, build with -fstack-usage -fno-lto' % name)
+        depth = a.depth(name)
+        total += depth
+        worst = max(worst, depth)
+        print('PCINT%-3d %-12s %8d' % (group, name, depth))
+    for w in sorted(set(a.warnings)):
+        print('  warning: %s' % w)
+
+    result = total if args.nested else worst
+    print('Maximum stack depth%s: %d bytes' % (' (nested)' if args.nested else '', result))
+    if args.limit and result > args.limit:
+        print('ERROR: stack depth exceeds the limit of %d bytes' % args.limit)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
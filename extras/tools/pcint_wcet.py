@@ -0,0 +1,328 @@
+#!/usr/bin/env python3
+#
+# pcint_wcet.py
+#
+# Static best/worst case execution time of the PCINT ISRs.
+#
+# Copyright (c) 2014 Kees Bakker
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# The ISR of each PCINT group (__vector_N) is disassembled with
+# avr-objdump and its control flow graph is walked with the AVR
+# instruction cycle table.  Direct calls (e.g. micros()) are analysed
+# recursively.  Indirect calls (icall/eicall) are the user handlers; only
+# the cost of the call itself is counted.
+#
+# Loops are bounded with --loop-bound (default 8, one pass per pin in a
+# group).  Each back edge adds (bound - 1) times the longest path through
+# its loop body.  Nested loops are not modelled, the tool reports them.
+# The best case takes the shortest path with every loop body run once.
+#
+# Both include the interrupt response (4 cycles, 5 with a 22 bit PC) and
+# the jump in the vector table: a jmp (3 cycles), or an rjmp (2 cycles) on
+# the MCUs with 1 word vectors (8K flash or less).  The worst case also includes
+# the rest of the instruction that is running when the interrupt comes:
+# up to 3 more cycles of a 4 cycle instruction (4 with a 22 bit PC).
+#
+# Usage:
+#   pcint_wcet.py --mcu atmega328p sketch.elf
+#   avr-objdump -d sketch.elf > sketch.lst; pcint_wcet.py --mcu atmega328p sketch.lst
+
+import argparse
+import re
+import subprocess
+import sys
+
+# Vector numbers of PCINT0..PCINT3 per MCU
+PCINT_VECTORS = {
+    'atmega88': [3, 4, 5],
+    'atmega168': [3, 4, 5],
+    'atmega328': [3, 4, 5],
+    'atmega328p': [3, 4, 5],
+    'atmega644p': [4, 5, 6, 7],
+    'atmega1284': [4, 5, 6, 7],
+    'atmega1284p': [4, 5, 6, 7],
+    'atmega1280': [9, 10, 11],
+    'atmega2560': [9, 10, 11],
+    'atmega32u4': [9],
+    'attiny84': [2, 3],
+    'attiny85': [2],
+}
+
+# MCUs with a 22 bit program counter (3 byte return address)
+PC22 = ('atmega2560', 'atmega2561')
+
+# MCUs with 1 word vectors, an rjmp in the vector table
+RJMP_VECTORS = ('atmega88', 'attiny84', 'attiny85')
+
+# Cycles per instruction, classic AVR core (AVRe/AVRe+)
+CYCLES = {
+    'adiw': 2, 'sbiw': 2, 'mul': 2, 'muls': 2, 'mulsu': 2,
+    'fmul': 2, 'fmuls': 2, 'fmulsu': 2,
+    'ld': 2, 'ldd': 2, 'lds': 2, 'st': 2, 'std': 2, 'sts': 2,
+    'push': 2, 'pop': 2, 'cbi': 2, 'sbi': 2,
+    'lpm': 3, 'elpm': 3, 'spm': 4,
+    'rjmp': 2, 'ijmp': 2, 'eijmp': 2, 'jmp': 3,
+    'rcall': 3, 'icall': 3, 'eicall': 4, 'call': 4,
+    'ret': 4, 'reti': 4,
+}
+BRANCHES = ('brbc', 'brbs', 'brcc', 'brcs', 'breq', 'brge', 'brhc', 'brhs',
+            'brid', 'brie', 'brlo', 'brlt', 'brmi', 'brne', 'brpl', 'brsh',
+            'brtc', 'brts', 'brvc', 'brvs')
+SKIPS = ('cpse', 'sbrc', 'sbrs', 'sbic', 'sbis')
+
+LINE_RE = re.compile(r'^\s*([0-9a-f]+):\s+((?:[0-9a-f]{2} )+)\s*(\S+)\s*(.*)$')
+LABEL_RE = re.compile(r'^([0-9a-f]+) <([^>]+)>:$')
+TARGET_RE = re.compile(r';\s*0x([0-9a-f]+)')
+
+
+class Insn(object):
+    def __init__(self, addr, size, op, args):
+        self.addr = addr
+        self.size = size
+        self.op = op
+        self.args = args
+
+    def target(self):
+        m = TARGET_RE.search(self.args)
+        if m:
+            return int(m.group(1), 16)
+        m = re.match(r'0x([0-9a-f]+)', self.args)
+        if m:
+            return int(m.group(1), 16)
+        raise ValueError('no target in %x: %s %s' % (self.addr, self.op, self.args))
+
+
+def read_listing(args):
+    if args.input.endswith('.elf'):
+        out = subprocess.check_output([args.objdump, '-d', args.input])
+        return out.decode('utf-8', 'replace').splitlines()
+    with open(args.input) as f:
+        return f.read().splitlines()
+
+
+def parse_functions(lines):
+    """Map function name -> (start address, [Insn])"""
+    funcs = {}
+    name = None
+    for line in lines:
+        m = LABEL_RE.match(line.strip())
+        if m:
+            name = m.group(2)
+            funcs[name] = (int(m.group(1), 16), [])
+            continue
+        m = LINE_RE.match(line)
+        if m and name:
+            size = len(m.group(2).split())
+            funcs[name][1].append(Insn(int(m.group(1), 16), size, m.group(3), m.group(4)))
+    return funcs
+
+
+class Analyser(object):
+    def __init__(self, funcs, loop_bound, pc22):
+        self.funcs = funcs
+        self.by_addr = dict((start, name) for name, (start, _) in funcs.items())
+        self.loop_bound = loop_bound
+        self.pc22 = pc22
+        self.cache = {}
+        self.active = set()
+        self.indirect = 0
+        self.warnings = []
+
+    def cycles(self, insn):
+        c = CYCLES.get(insn.op, 1)
+        if self.pc22 and insn.op in ('rcall', 'call', 'icall', 'ret', 'reti'):
+            c += 1
+        return c
+
+    def callee(self, insn):
+        name = self.by_addr.get(insn.target())
+        if name is None:
+            self.warnings.append('call to unknown address 0x%x' % insn.target())
+            return (0, 0)
+        return self.analyse(name)
+
+    def edges(self, insns, addr_index, index):
+        """List of (successor index or None for exit, best, worst) cycles"""
+        insn = insns[index]
+        nxt = index + 1 if index + 1 < len(insns) else None
+        c = self.cycles(insn)
+        if insn.op in ('ret', 'reti'):
+            return [(None, c, c)]
+        if insn.op in ('rjmp', 'jmp'):
+            t = insn.target()
+            if t in addr_index:
+                return [(addr_index[t], c, c)]
+            # Tail call
+            best, worst = self.callee(insn)
+            return [(None, c + best, c + worst)]
+        if insn.op in ('ijmp', 'eijmp'):
+            self.warnings.append('indirect jump at 0x%x not followed' % insn.addr)
+            return [(None, c, c)]
+        if insn.op in ('call', 'rcall'):
+            best, worst = self.callee(insn)
+            return [(nxt, c + best, c + worst)]
+        if insn.op in ('icall', 'eicall'):
+            self.indirect += 1
+            return [(nxt, c, c)]
+        if insn.op in BRANCHES:
+            return [(nxt, 1, 1), (addr_index[insn.target()], 2, 2)]
+        if insn.op in SKIPS:
+            skip = index + 2 if index + 2 < len(insns) else None
+            # Insn.size is in bytes: 2 cycles over a 1 word, 3 over a 2 word instruction
+            s = 1 + insns[index + 1].size // 2
+            return [(nxt, 1, 1), (skip, s, s)]
+        return [(nxt, c, c)]
+
+    def analyse(self, name):
+        if name in self.cache:
+            return self.cache[name]
+        if name in self.active:
+            self.warnings.append('recursion through %s not bounded' % name)
+            return (0, 0)
+        self.active.add(name)
+        insns = self.funcs[name][1]
+        n = len(insns)
+        addr_index = dict((i.addr, k) for k, i in enumerate(insns))
+        succ = [self.edges(insns, addr_index, i) for i in range(n)]
+
+        # Find back edges with a depth first search
+        back = set()
+        state = [0] * n
+        stack = [(0, iter(succ[0]))]
+        state[0] = 1
+        while stack:
+            node, it = stack[-1]
+            for (s, _, _) in it:
+                if s is None:
+                    continue
+                if state[s] == 1:
+                    back.add((node, s))
+                elif state[s] == 0:
+                    state[s] = 1
+                    stack.append((s, iter(succ[s])))
+                    break
+            else:
+                state[node] = 2
+                stack.pop()
+
+        # Topological order of the acyclic graph
+        order = []
+        seen = [False] * n
+        def visit(i):
+            work = [(i, False)]
+            while work:
+                node, done = work.pop()
+                if done:
+                    order.append(node)
+                    continue
+                if seen[node]:
+                    continue
+                seen[node] = True
+                work.append((node, True))
+                for (s, _, _) in succ[node]:
+                    if s is not None and (node, s) not in back and not seen[s]:
+                        work.append((s, False))
+        visit(0)
+        order.reverse()
+
+        def paths(src, dst):
+            """Shortest and longest path src -> dst (None = exit)"""
+            inf = float('inf')
+            best = dict((i, inf) for i in order)
+            worst = dict((i, -inf) for i in order)
+            best[src] = worst[src] = 0
+            end_best, end_worst = inf, -inf
+            for node in order:
+                if worst[node] == -inf:
+                    continue
+                for (s, b, w) in succ[node]:
+                    if (node, s) in back:
+                        if dst == s and node != src:
+                            end_best = min(end_best, best[node] + b)
+                            end_worst = max(end_worst, worst[node] + w)
+                        continue
+                    if s is None:
+                        if dst is None:
+                            end_best = min(end_best, best[node] + b)
+                            end_worst = max(end_worst, worst[node] + w)
+                        continue
+                    best[s] = min(best[s], best[node] + b)
+                    worst[s] = max(worst[s], worst[node] + w)
+            return end_best, end_worst
+
+        best, worst = paths(0, None)
+        headers = [h for (_, h) in back]
+        if len(set(headers)) != len(headers):
+            self.warnings.append('%s: loop with multiple back edges, bound may be low' % name)
+        for (latch, header) in back:
+            inner = [h for (l, h) in back if h != header and
+                     insns[header].addr < insns[h].addr <= insns[latch].addr]
+            if inner:
+                self.warnings.append('%s: nested loop at 0x%x not modelled' % (name, insns[header].addr))
+            _, body = paths(header, header)
+            if body != -float('inf'):
+                worst += (self.loop_bound - 1) * body
+        self.active.discard(name)
+        self.cache[name] = (best, worst)
+        return best, worst
+
+
+def entry_cycles(mcu):
+    """Interrupt response plus the jump in the vector table, without the
+    extra cycle of a 22 bit PC"""
+    return 4 + (2 if mcu in RJMP_VECTORS else 3)
+
+
+def isr_cycles(funcs, name, mcu, loop_bound=8, entry=None):
+    """Best and worst case cycles of an ISR from the interrupt request,
+    and its Analyser (for the warnings)"""
+    pc22 = mcu in PC22
+    a = Analyser(funcs, loop_bound, pc22)
+    best, worst = a.analyse(name)
+    if entry is None:
+        entry = entry_cycles(mcu)
+    entry += 1 if pc22 else 0
+    inflight = 4 if pc22 else 3
+    return best + entry, worst + entry + inflight, a
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Best/worst case cycles of the PCINT ISRs')
+    parser.add_argument('input', help='ELF file (.elf) or avr-objdump -d listing')
+    parser.add_argument('--mcu', required=True, help='e.g. atmega328p')
+    parser.add_argument('--loop-bound', type=int, default=8)
+    parser.add_argument('--objdump', default='avr-objdump')
+    parser.add_argument('--entry', type=int,
+                        help='interrupt response and vector jump cycles added to each ISR '
+                        '(default 7, 6 with an rjmp in the vector table)')
+    args = parser.parse_args()
+
+    if args.mcu not in PCINT_VECTORS:
+        sys.exit('Unknown MCU %s, known: %s' % (args.mcu, ' '.join(sorted(PCINT_VECTORS))))
+    funcs = parse_functions(read_listing(args))
+    pc22 = args.mcu in PC22
+    if args.entry is None:
+        args.entry = entry_cycles(args.mcu)
+    entry = args.entry + (1 if pc22 else 0)
+    inflight = 4 if pc22 else 3
+
+    print('%-8s %-12s %8s %8s %8s' % ('group', 'vector', 'best', 'worst', 'handlers'))
+    for group, vector in enumerate(PCINT_VECTORS[args.mcu]):
+        name = '__vector_%d' % vector
+        if name not in funcs:
+            continue
+        best, worst, a = isr_cycles(funcs, name, args.mcu, args.loop_bound, args.entry)
+        print('PCINT%-3d %-12s %8d %8d %8d' % (group, name, best, worst, a.indirect))
+        for w in a.warnings:
+            print('  warning: %s' % w)
+    print('Cycles include %d cycles interrupt response and vector jump, the worst case %d more '
+          'for the instruction in flight; they exclude the user handlers.' % (entry, inflight))
+
+
+if __name__ == '__main__':
+    main()
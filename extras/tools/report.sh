@@ -0,0 +1,56 @@
+#!/bin/sh
+#
+# Build a sketch with the library and report its flash/RAM usage and the
+# best/worst case cycles of the PCINT ISRs.
+#
+# usage: extras/tools/report.sh [FQBN] [SKETCH] [EXTRA_FLAGS]
+#
+#   FQBN         board, default arduino:avr:uno
+#   SKETCH       sketch directory, default examples/PcIntBasic
+#   EXTRA_FLAGS  extra compiler flags, e.g. "-DPCINT_PROFILING"
+#
+# The stack depth of the ISRs is reported as well.  Set HANDLERS to the
+# names of the sketch's handlers (e.g. HANDLERS="handleA0") to include
+# them, NESTED=1 for non-blocking ISRs, and STACK_LIMIT to a number of
+# bytes to make the report fail when the ISR stack depth exceeds it.
+#
+# The sketch, the core and the library are built without LTO: with LTO
+# gcc writes no stack usage for the code it generates at link time.
+#
+# Needs arduino-cli, avr-size and avr-objdump in the PATH.  Run it from
+# the top of the library.
+
+FQBN="${1:-arduino:avr:uno}"
+SKETCH="${2:-examples/PcIntBasic}"
+EXTRA_FLAGS="$3"
+
+case "${FQBN}" in
+  *:uno|*:nano*|*:pro*|*:mini*) MCU=atmega328p ;;
+  *:mega*) MCU=atmega2560 ;;
+  *:leonardo|*:micro) MCU=atmega32u4 ;;
+  *mbili*|*1284*) MCU=atmega1284p ;;
+  *) [ -z "${MCU}" ] && { echo "ERROR: Cannot derive MCU from '${FQBN}'. Set MCU."; exit 1; } ;;
+esac
+
+TOOLS="$(dirname $0)"
+OUT=$(mktemp -d /tmp/pcint-report.XXXXXX)
+trap 'rm -fr ${OUT}' EXIT
+
+arduino-cli compile --fqbn "${FQBN}" --library . --output-dir "${OUT}" \
+  --build-path "${OUT}/build" \
+  --build-property "compiler.c.extra_flags=-fstack-usage -fno-lto" \
+  --build-property "compiler.cpp.extra_flags=-fstack-usage -fno-lto ${EXTRA_FLAGS}" \
+  "${SKETCH}" > /dev/null || exit 1
+ELF=$(ls ${OUT}/*.elf)
+
+echo "== ${SKETCH} (${FQBN}) ${EXTRA_FLAGS}"
+avr-size -C --mcu=${MCU} ${ELF} | grep -E "^(Program|Data):"
+python3 ${TOOLS}/pcint_wcet.py --mcu ${MCU} ${ELF}
+
+STACK_ARGS="--su-dir ${OUT}/build"
+for h in ${HANDLERS}; do
+  STACK_ARGS="${STACK_ARGS} --handler ${h}"
+done
+[ -n "${NESTED}" ] && STACK_ARGS="${STACK_ARGS} --nested"
+[ -n "${STACK_LIMIT}" ] && STACK_ARGS="${STACK_ARGS} --limit ${STACK_LIMIT}"
+python3 ${TOOLS}/pcint_stack.py --mcu ${MCU} ${STACK_ARGS} ${ELF}
@@ -28,33 +28,465 @@
 
 #include <stdint.h>
 
+// The PCINTn_vect defines below count the groups, whatever the sketch
+// included first
+#if !defined(ARDUINO_ARCH_SAMD)
+#include <avr/io.h>
+#endif
+
+#include "Sodaq_PcInt_config.h"
+#include "Sodaq_PcInt_pins.h"
+
+#if defined(PCINT_STATIC_HANDLERS)
+#if !defined(PCINT_PIN_TABLE)
+#error "PCINT_STATIC_HANDLERS needs the pin table of the board in Sodaq_PcInt_pins.h"
+#endif
+#if defined(PCINT_COMPACT_HANDLERS)
+#error "PCINT_STATIC_HANDLERS cannot be combined with PCINT_COMPACT_HANDLERS"
+#endif
+#if defined(PCINT_ATTACH_SHIM)
+#error "PCINT_STATIC_HANDLERS cannot be combined with PCINT_ATTACH_SHIM"
+#endif
+#endif
+
+#if defined(PCINT_PROFILING) || defined(PCINT_BUDGETS)
+#define PCINT_TIME_FUNCS
+#endif
+
+// The pass-through pins are measured as well
+#if defined(PCINT_PASSTHROUGH) && !defined(PCINT_TIMESTAMPS)
+#define PCINT_TIMESTAMPS
+#endif
+
+// Remember the port state to know which pins changed
+#if defined(PCINT_FILTERS) || defined(PCINT_STATIC_HANDLERS) || defined(PCINT_ATTACH_SHIM) || \
+    defined(PCINT_TIMESTAMPS)
+#define PCINT_TRACK_CHANGES
+#endif
+
+// Room for the configuration changes made by the handlers of one interrupt
+#if defined(PCINT_STAGED_CONFIG) && !defined(PCINT_STAGED_SIZE)
+#define PCINT_STAGED_SIZE       4
+#endif
+
+// Marks the interrupt numbers of PcInt::toInterrupt() that are a pin
+#define PCINT_SHIM_PIN          0x80
+
+/*
+ * On SAMD21 the pins are handled by the External Interrupt Controller,
+ * one group with a channel (EXTINT) per pin.  See Sodaq_PcInt_samd.cpp.
+ */
+#if defined(ARDUINO_ARCH_SAMD)
+#define PCINT_EIC_CHANNELS      16
+#if defined(PCINT_PROFILING) || defined(PCINT_BUDGETS) || defined(PCINT_COMPACT_HANDLERS) || \
+    defined(PCINT_DEFERRED) || defined(PCINT_GROUP_HOOKS) || defined(PCINT_FILTERS) || \
+    defined(PCINT_STATIC_HANDLERS) || defined(PCINT_HEADER_ONLY) || defined(PCINT_ATTACH_SHIM) || \
+    defined(PCINT_STAGED_CONFIG) || defined(PCINT_TIMESTAMPS)
+#error "This option is not available on SAMD"
+#endif
+#endif
+
+#if defined(PCINT3_vect)
+#define PCINT_NUM_GROUPS        4
+#elif defined(PCINT2_vect)
+#define PCINT_NUM_GROUPS        3
+#elif defined(PCINT1_vect)
+#define PCINT_NUM_GROUPS        2
+#else
+#define PCINT_NUM_GROUPS        1
+#endif
+
+/*
+ * Storage class of the library state.  The host simulation defines it as
+ * thread_local, to run a virtual board per thread.
+ */
+#ifndef PCINT_STATE
+#define PCINT_STATE
+#endif
+
+#if defined(PCINT_NO_ISR)
+#define PCINT_HANDLE_INLINE
+#define PCINT_HANDLE_ATTR
+#else
+#define PCINT_HANDLE_INLINE     inline
+#define PCINT_HANDLE_ATTR       __attribute__((__always_inline__))
+#endif
+
+#if defined(PCINT_COMPACT_HANDLERS)
+/*
+ * Define the PROGMEM table with the handlers that can be attached.  Use
+ * it once, at file scope in the sketch.
+ */
+#define PCINT_HANDLER_TABLE(...) \
+  void (* const PcInt::_handlers[])(void) PROGMEM = { 0, __VA_ARGS__ }; \
+  const uint8_t PcInt::_nrHandlers = sizeof(PcInt::_handlers) / sizeof(PcInt::_handlers[0])
+#endif
+
+// Handlers known at compile time, called without the dispatch table
+#if defined(PCINT_HEADER_ONLY) && defined(PCINT_PIN_TABLE) && !defined(PCINT_STATIC_HANDLERS)
+#define PCINT_INLINE_HANDLERS
+#endif
+
+#if defined(PCINT_INLINE_HANDLERS)
+/*
+ * Declare the handler of a pin at file scope, before including
+ * Sodaq_PcInt_impl.h.  The ISR calls it directly, so it can be inlined
+ * and the ISR only saves the registers that it uses.  The handler must
+ * still be attached to set up the pin, but a group with inline handlers
+ * does not use its dispatch table: all handlers of the group must be
+ * declared this way.
+ */
+#define PCINT_INLINE_HANDLER(pin, func) \
+  static_assert((pin) < sizeof(pcintPins) / sizeof(pcintPins[0]) && pcintPins[(pin)].group != PCINT_NO_GROUP, \
+                "The pin has no pin change interrupt"); \
+  template <> struct PcInt::InlineHandler<pcintPins[(pin)].group, pcintBitNr(pcintPins[(pin)].portBitMask)> \
+  { \
+    static constexpr bool defined = true; \
+    void operator()() const { func(); } \
+  }
+#endif
+
+#if defined(PCINT_STATIC_HANDLERS)
+#define PCINT_CONCAT_(a, b)     a ## b
+#define PCINT_CONCAT(a, b)      PCINT_CONCAT_(a, b)
+
+/*
+ * Declare the handler of a pin, at file scope.  Mode is CHANGE, RISING
+ * or FALLING.  The linker collects the entries in the pcint_handlers
+ * section, and PcInt::begin() enables their interrupts.  The explicit
+ * alignment keeps the compiler from padding the entries, so that the
+ * section is an array.
+ */
+#define PCINT_HANDLER(pin, mode, func) \
+  static_assert((pin) < sizeof(pcintPins) / sizeof(pcintPins[0]) && pcintPins[(pin)].group != PCINT_NO_GROUP, \
+                "The pin has no pin change interrupt"); \
+  static const PcInt::StaticHandler PCINT_CONCAT(_pcintHandler, __LINE__) \
+    __attribute__((__used__, __section__("pcint_handlers"), \
+                   __aligned__(__alignof__(PcInt::StaticHandler)))) = { \
+      pcintPins[(pin)].group, pcintBitNr(pcintPins[(pin)].portBitMask), (mode), \
+      pcintPins[(pin)].pcie, pcintPins[(pin)].pcicr, pcintPins[(pin)].pcmsk, pcintPins[(pin)].pcmskBit, \
+      pcintPins[(pin)].port, (func) }
+#endif
+
 class PcInt
 {
 public:
+#if defined(PCINT_COMPACT_HANDLERS)
+  // Index in _handlers, 0 means no handler
+  typedef uint8_t Slot;
+#else
+  typedef void (*Slot)(void);
+#endif
+
+#if defined(PCINT_STATIC_HANDLERS)
+  // An entry of PCINT_HANDLER(), in flash
+  struct StaticHandler
+  {
+    uint8_t group;
+    uint8_t nr;                 // bit of the pin in its port
+    uint8_t mode;               // CHANGE, RISING or FALLING
+    uint8_t pcie;               // PCICR bit of the group
+    uint8_t pcicr;              // data address of PCICR
+    uint8_t pcmsk;              // data address of the PCMSK of the group
+    uint8_t pcmskBit;
+    uint16_t port;              // data address of the PIN register
+    void (*func)(void);
+  };
+  // Enable the interrupts of the declared handlers, after their pinMode()
+  static void begin();
+#else
   static void attachInterrupt(uint8_t pin, void (*func)(void));
   static void detachInterrupt(uint8_t pin);
+#if defined(PCINT_PIN_TABLE)
+  // The same, with the pin known at compile time.  The compiler rejects
+  // pins without a pin change interrupt, and no pin tables are read.
+  template <uint8_t pin> static inline void attachInterrupt(void (*func)(void));
+#endif
+#if defined(PCINT_ATTACH_SHIM)
+  // Call the handler only for the edges of mode: CHANGE, RISING or
+  // FALLING (LOW is taken as FALLING)
+  static void attachInterrupt(uint8_t pin, void (*func)(void), uint8_t mode);
+
+  // The interrupt numbers of the core, plus PCINT_SHIM_PIN | pin for the
+  // pins that only have a pin change interrupt.  Used by
+  // Sodaq_PcInt_attach.h in place of the core's functions.
+  static int toInterrupt(uint8_t pin);
+  static void attachInterruptNum(uint8_t num, void (*func)(void), int mode);
+  static void detachInterruptNum(uint8_t num);
+#endif
+#endif
   static void enableInterrupt(uint8_t pin);
   static void disableInterrupt(uint8_t pin);
 
+#if defined(PCINT_INLINE_HANDLERS)
+  // The handler of bit nr of a group, specialized by PCINT_INLINE_HANDLER()
+  template <uint8_t group, uint8_t nr> struct InlineHandler
+  {
+    static constexpr bool defined = false;
+    void operator()() const {}
+  };
+#endif
+
+#if defined(ARDUINO_ARCH_SAMD)
+  // The EIC detects the edge (CHANGE, RISING or FALLING) in hardware
+  static void attachInterrupt(uint8_t pin, void (*func)(void), uint8_t mode);
+#else
   // These must be public so they can be called from ISR
-  static inline void handlePCINT0() __attribute__((__always_inline__));
-  static inline void handlePCINT1() __attribute__((__always_inline__));
-  static inline void handlePCINT2() __attribute__((__always_inline__));
-  static inline void handlePCINT3() __attribute__((__always_inline__));
+  static PCINT_HANDLE_INLINE void handlePCINT0() PCINT_HANDLE_ATTR;
+  static PCINT_HANDLE_INLINE void handlePCINT1() PCINT_HANDLE_ATTR;
+  static PCINT_HANDLE_INLINE void handlePCINT2() PCINT_HANDLE_ATTR;
+  static PCINT_HANDLE_INLINE void handlePCINT3() PCINT_HANDLE_ATTR;
+#endif
+
+#if defined(PCINT_GROUP_HOOKS)
+  // A hook is called from the ISR of its group on every interrupt, before
+  // the pin handlers.  The hook object must stay alive while attached.
+  // The owner of the hook sets its own PCMSK and PCICR bits.
+  struct GroupHook
+  {
+    void (*func)(void);
+    GroupHook * next;
+  };
+  static void attachGroupHook(uint8_t group, GroupHook & hook);
+  static void detachGroupHook(uint8_t group, GroupHook & hook);
+#endif
+
+#if defined(PCINT_FILTERS)
+  // The filter is called once per interrupt of the group with the mask of
+  // changed pins (bit n is getFunc(group, n)).  Only the handlers of the
+  // bits in the returned mask are called.
+  static void setFilter(uint8_t group, uint8_t (*filter)(uint8_t group, uint8_t changed));
+#endif
+
+#if defined(PCINT_DEFERRED)
+  // Call the handlers of the groups that had an interrupt, from loop()
+  static void dispatchPending();
+#endif
+
+  // Run the handlers as if the pin changed to level, or as if the pins
+  // in changed had an interrupt with the port in state.  For testing.
+  static void inject(uint8_t pin, uint8_t level);
+  static void injectMask(uint8_t group, uint8_t changed, uint8_t state);
+#if defined(PCINT_TRACK_CHANGES)
+  static uint8_t getState(uint8_t group);
+#endif
+
+#if defined(PCINT_TIMESTAMPS)
+  // The micros() of the last edge of a pin, and how long the pin had
+  // its previous level before that edge.  After a falling edge that is
+  // the width of the high pulse.
+  static uint32_t getEdgeTime(uint8_t pin);
+  static uint32_t getLevelTime(uint8_t pin);
+#endif
+
+#if defined(PCINT_PASSTHROUGH)
+  // Copy the level of inPin to outPin at the start of its ISR, before
+  // anything else.  outPin is made an output.
+  static void setPassthrough(uint8_t inPin, uint8_t outPin);
+  static void clearPassthrough(uint8_t inPin);
+  // While overridden the ISR leaves outPin alone, e.g. for a failsafe
+  // that drives the servo itself.  Ending the override copies the
+  // level of inPin right away.
+  static void overridePassthrough(uint8_t inPin, bool override);
+#endif
 
   // For diagnostic purposes
   static void (*getFunc(uint8_t group, uint8_t nr))(void);
+
+#if defined(PCINT_PROFILING)
+  // Time (in microseconds) spent in the ISR of a group, and in a handler
+  static uint32_t getGroupTime(uint8_t group);
+  static uint32_t getFuncTime(uint8_t group, uint8_t nr);
+
+  // Execution statistics of a handler, all times in microseconds
+  struct FuncStats
+  {
+    uint32_t time;              // total time
+    uint32_t count;             // number of calls
+    uint16_t min;               // shortest call
+    uint16_t max;               // longest call
+  };
+  static bool getFuncStats(uint8_t group, uint8_t nr, FuncStats & stats);
+  static uint16_t getFuncAverage(uint8_t group, uint8_t nr);
+  // The nr of the handler with the longest call in the group, 0xFF if none
+  static uint8_t getSlowestFunc(uint8_t group);
+  // Percentage of CPU time spent in the ISRs since the previous call
+  static uint8_t getLoad();
+  static void resetProfile();
+#endif
+
+#if defined(PCINT_BUDGETS)
+  // Set the maximum execution time (in microseconds) of the handler of
+  // the pin, 0 means no budget
+  static void setBudget(uint8_t pin, uint16_t budget);
+  static uint16_t getOverruns(uint8_t group, uint8_t nr);
+  static void clearOverruns();
+  // The overrun handler is called from the ISR after each overrun
+  static void setOverrunHandler(void (*func)(uint8_t group, uint8_t nr, uint16_t elapsed));
+#endif
+
 private:
-  static void   (*_funcs0[8])(void);
-#if defined(PCINT1_vect)
-  static void   (*_funcs1[8])(void);
+#if !defined(PCINT_STATIC_HANDLERS)
+  static void attachPin(uint8_t group, uint8_t portBitMask, volatile uint8_t * port, void (*func)(void));
+  static inline Slot toSlot(void (*func)(void)) __attribute__((__always_inline__));
+  static inline void (*toFunc(Slot slot))(void) __attribute__((__always_inline__));
+  static inline Slot * groupFuncs(uint8_t group) __attribute__((__always_inline__));
 #endif
-#if defined(PCINT2_vect)
-  static void   (*_funcs2[8])(void);
+  template <class Func>
+  static inline void callFunc(uint8_t group, uint8_t nr, Func func) __attribute__((__always_inline__));
+#if defined(PCINT_INLINE_HANDLERS)
+  // Call the inline handlers of bits nr..7 of a group
+  template <uint8_t group, uint8_t nr = 0> struct InlineDispatch
+  {
+    static constexpr bool any = InlineHandler<group, nr>::defined || InlineDispatch<group, nr + 1>::any;
+    static inline void call(uint8_t changed) __attribute__((__always_inline__))
+    {
+      if (InlineHandler<group, nr>::defined && (changed & (1 << nr))) {
+        callFunc(group, nr, InlineHandler<group, nr>());
+      }
+      InlineDispatch<group, nr + 1>::call(changed);
+    }
+  };
+  template <uint8_t group> struct InlineDispatch<group, 8>
+  {
+    static constexpr bool any = false;
+    static inline void call(uint8_t) {}
+  };
+  static inline bool dispatchInline(uint8_t group, uint8_t changed) __attribute__((__always_inline__));
 #endif
-#if defined(PCINT3_vect)
-  static void   (*_funcs3[8])(void);
+  static inline void dispatch(uint8_t group) __attribute__((__always_inline__));
+  static inline void dispatch(uint8_t group, uint8_t changed, uint8_t state) __attribute__((__always_inline__));
+#if defined(PCINT_TIMESTAMPS)
+  static inline void stamp(uint8_t group, uint8_t changed) __attribute__((__always_inline__));
+#if defined(PCINT_DEFERRED)
+  static inline void stampPort(uint8_t group) __attribute__((__always_inline__));
+#endif
+#endif
+#if defined(PCINT_GROUP_HOOKS)
+  static inline void callHooks(uint8_t group) __attribute__((__always_inline__));
+#endif
+#if defined(PCINT_PASSTHROUGH)
+  static inline void mirror(uint8_t group) __attribute__((__always_inline__));
+  static void setPassActive(uint8_t inPin, bool active);
+#endif
+#if defined(PCINT_STAGED_CONFIG)
+  enum { STAGE_ATTACH, STAGE_DETACH, STAGE_ENABLE, STAGE_DISABLE };
+  // A change of the configuration made while handlers are called
+  struct StagedChange
+  {
+    uint8_t op;                 // STAGE_xxx
+    uint8_t pin;
+    uint8_t mode;               // of STAGE_ATTACH
+    void (*func)(void);
+  };
+  static bool stage(uint8_t op, uint8_t pin, void (*func)(void), uint8_t mode);
+  static void commitStaged();
+#endif
+#if defined(PCINT_DEFERRED)
+  static inline void setPending(uint8_t group) __attribute__((__always_inline__));
+  static inline bool takePending(uint8_t group) __attribute__((__always_inline__));
+#endif
+
+#if defined(PCINT_COMPACT_HANDLERS)
+  static void   (* const _handlers[])(void);
+  static const uint8_t _nrHandlers;
+#endif
+
+  /*
+   * All the state of a group, in one block, indexed by the group.  The
+   * fields that every interrupt uses come first, the per handler
+   * statistics last.
+   */
+  struct Group
+  {
+#if defined(PCINT_TRACK_CHANGES)
+    volatile uint8_t * port;
+    uint8_t last;
+#endif
+#if defined(PCINT_TIMESTAMPS) && defined(PCINT_DEFERRED)
+    // The port state at the last timestamp, taken in the ISR
+    uint8_t stamped;
+#endif
+#if defined(PCINT_PASSTHROUGH)
+    // The pins that are copied now, and where to
+    uint8_t passMask;
+    uint8_t passOutMask[8];
+    volatile uint8_t * passOut[8];
+#endif
+#if defined(PCINT_ATTACH_SHIM)
+    // The pins whose handler skips a rising, or a falling, edge
+    uint8_t skipRise;
+    uint8_t skipFall;
+#endif
+#if defined(PCINT_FILTERS)
+    uint8_t (*filter)(uint8_t group, uint8_t changed);
+#endif
+#if defined(PCINT_GROUP_HOOKS)
+    GroupHook * hooks;
+#endif
+#if !defined(PCINT_STATIC_HANDLERS)
+    Slot funcs[8];
+#endif
+#if defined(PCINT_TIMESTAMPS)
+    uint32_t edgeTime[8];
+    uint32_t levelTime[8];
+#endif
+#if defined(PCINT_PROFILING)
+    uint32_t time;
+#endif
+#if defined(PCINT_BUDGETS)
+    uint16_t funcBudget[8];
+    uint16_t funcOverruns[8];
+#endif
+#if defined(PCINT_PROFILING)
+    FuncStats funcStats[8];
+#endif
+  };
+  static PCINT_STATE Group _groups[PCINT_NUM_GROUPS];
+
+#if defined(ARDUINO_ARCH_SAMD)
+  static PCINT_STATE void (*_channelFuncs[PCINT_EIC_CHANNELS])(void);
+  static PCINT_STATE uint8_t _channelModes[PCINT_EIC_CHANNELS];
+#endif
+
+#if defined(PCINT_DEFERRED) && !defined(PCINT_PENDING_GPIOR)
+  static PCINT_STATE volatile uint8_t _pending;
+#endif
+
+#if defined(PCINT_STAGED_CONFIG)
+  static PCINT_STATE StagedChange _staged[PCINT_STAGED_SIZE];
+  static PCINT_STATE uint8_t _nrStaged;
+  static PCINT_STATE uint8_t _dispatching;       // nesting depth of dispatch()
+#endif
+
+#if defined(PCINT_PROFILING)
+  static PCINT_STATE uint32_t _loadTime;
+  static PCINT_STATE uint32_t _loadStart;
+#endif
+
+#if defined(PCINT_BUDGETS)
+  static PCINT_STATE void   (*_overrunFunc)(uint8_t group, uint8_t nr, uint16_t elapsed);
 #endif
 };
 
+#if defined(PCINT_PIN_TABLE) && !defined(PCINT_STATIC_HANDLERS)
+template <uint8_t pin>
+inline void PcInt::attachInterrupt(void (*func)(void))
+{
+  static_assert(pin < sizeof(pcintPins) / sizeof(pcintPins[0]) && pcintPins[pin].group != PCINT_NO_GROUP,
+                "The pin has no pin change interrupt");
+#if defined(PCINT_STAGED_CONFIG)
+  if (_dispatching) {
+    // Staged by the run time version
+    attachInterrupt(pin, func);
+    return;
+  }
+#endif
+  attachPin(pcintPins[pin].group, pcintPins[pin].portBitMask,
+            &_SFR_MEM8(pcintPins[pin].port), func);
+  _SFR_MEM8(pcintPins[pin].pcmsk) |= _BV(pcintPins[pin].pcmskBit);
+  _SFR_MEM8(pcintPins[pin].pcicr) |= _BV(pcintPins[pin].pcie);
+}
+#endif
+
 #endif /* SODAQ_PCINT_H_ */
@@ -0,0 +1,60 @@
+/*
+ * Sodaq_PcInt_attach.h
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ *
+ * Route the Arduino attachInterrupt() through PcInt (PCINT_ATTACH_SHIM).
+ *
+ * A driver written as
+ *
+ *   attachInterrupt(digitalPinToInterrupt(pin), isr, FALLING);
+ *
+ * gets NOT_AN_INTERRUPT for a pin without an external interrupt (INTx).
+ * After this header, digitalPinToInterrupt() gives such a pin a number
+ * of its own, and attachInterrupt() and detachInterrupt() hand those
+ * numbers to PcInt, with the edge mode.  The INTx pins still use the
+ * core.
+ *
+ * Include it in the driver, after its other includes.  Do not give it
+ * to the whole build (-include): the library's own files call the
+ * PcInt members of the same names, which the macros break.  In the
+ * files that include it, those must be called as
+ * (PcInt::attachInterrupt)(pin, func).  In C files it does nothing.
+ */
+
+#ifndef SODAQ_PCINT_ATTACH_H_
+#define SODAQ_PCINT_ATTACH_H_
+
+#if defined(__cplusplus)
+
+#include <Arduino.h>
+
+#include "Sodaq_PcInt.h"
+
+#if !defined(PCINT_ATTACH_SHIM)
+#error "Sodaq_PcInt_attach.h needs PCINT_ATTACH_SHIM, see Sodaq_PcInt_config.h"
+#endif
+
+#undef digitalPinToInterrupt
+#define digitalPinToInterrupt(pin)              PcInt::toInterrupt(pin)
+#define attachInterrupt(num, func, mode)        PcInt::attachInterruptNum(num, func, mode)
+#define detachInterrupt(num)                    PcInt::detachInterruptNum(num)
+
+#endif
+
+#endif /* SODAQ_PCINT_ATTACH_H_ */
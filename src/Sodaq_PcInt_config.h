@@ -0,0 +1,149 @@
+/*
+ * Sodaq_PcInt_config.h
+ *
+ * Compile time options for the PcInt library.  Uncomment a define
+ * below, or pass it to the compiler (e.g. -DPCINT_PROFILING), to enable
+ * the option.  All options are off by default, which gives the smallest
+ * code.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+
+#ifndef SODAQ_PCINT_CONFIG_H_
+#define SODAQ_PCINT_CONFIG_H_
+
+/*
+ * Keep track of the time (in microseconds) spent in the PCINT ISRs,
+ * per group and per handler.  See PcInt::getLoad().
+ */
+//#define PCINT_PROFILING
+
+/*
+ * Give handlers a time budget (in microseconds).  A call that takes
+ * longer is counted as an overrun.  See PcInt::setBudget().
+ */
+//#define PCINT_BUDGETS
+
+/*
+ * Store a one byte index per pin instead of a function pointer.  The
+ * handlers must be listed in a PROGMEM table in the sketch with
+ * PCINT_HANDLER_TABLE(handleA0, handleA1, ...).  Only listed handlers can
+ * be attached.
+ */
+//#define PCINT_COMPACT_HANDLERS
+
+/*
+ * Deferred dispatch.  The ISR only marks its group as pending; the
+ * handlers are called from the main loop by PcInt::dispatchPending().
+ */
+//#define PCINT_DEFERRED
+
+/*
+ * Keep the pending flags of PCINT_DEFERRED in GPIOR0 (bits 0..3)
+ * instead of SRAM.  The ISR is then a single sbi plus reti.  Only a
+ * register in the bit addressable I/O space (0x00..0x1F) works, so
+ * GPIOR0 and not GPIOR1/GPIOR2; others fail to assemble.  The register
+ * must not be used by anything else.
+ */
+//#define PCINT_PENDING_GPIOR     GPIOR0
+
+/*
+ * Let other libraries hook into the PCINT ISRs, see
+ * PcInt::attachGroupHook().
+ */
+//#define PCINT_GROUP_HOOKS
+
+/*
+ * Do not define the ISR(PCINTn_vect) functions.  Another library (or the
+ * sketch) defines them and must call PcInt::handlePCINTn() from them.
+ * Not used on SAMD, where EIC_Handler() is the core's.
+ */
+//#define PCINT_NO_ISR
+
+/*
+ * A filter per group that gets the mask of changed pins before the
+ * handlers are called, and can clear bits in it.  See PcInt::setFilter().
+ * With this option only the handlers of the changed pins are called.
+ */
+//#define PCINT_FILTERS
+
+/*
+ * The handlers are declared with PCINT_HANDLER(pin, mode, func) at file
+ * scope and collected by the linker in a table in flash.  There are no
+ * handler tables in SRAM and no PcInt::attachInterrupt().  The sketch
+ * calls PcInt::begin() once, after setting the pin modes.  Needs the pin
+ * table of the board, see Sodaq_PcInt_pins.h.
+ */
+//#define PCINT_STATIC_HANDLERS
+
+/*
+ * Compile the library in the sketch instead of in Sodaq_PcInt.cpp.  The
+ * sketch includes <Sodaq_PcInt_impl.h> once, after its handlers.  With
+ * PCINT_INLINE_HANDLER(pin, func) the compiler then inlines the handler
+ * in the ISR.  See Sodaq_PcInt.h.
+ */
+//#define PCINT_HEADER_ONLY
+
+/*
+ * SAMD only: enable the majority filter of the EIC on the attached
+ * pins.  Pulses shorter than about 3 periods of the EIC clock are
+ * ignored.
+ */
+//#define PCINT_EIC_FILTER
+
+/*
+ * Let drivers that use the Arduino attachInterrupt() work on all pins
+ * with a pin change interrupt, see Sodaq_PcInt_attach.h.  This also
+ * adds the edge mode to PcInt::attachInterrupt().
+ */
+//#define PCINT_ATTACH_SHIM
+
+/*
+ * Changes of the configuration made by a handler (attachInterrupt,
+ * detachInterrupt, enableInterrupt and disableInterrupt) are queued and
+ * done after the last handler of the interrupt, so all handlers of an
+ * interrupt see the same configuration.  PCINT_STAGED_SIZE is the
+ * length of the queue.  When it is full the queued changes are done
+ * right away, in order, before the next one is queued.
+ */
+//#define PCINT_STAGED_CONFIG
+//#define PCINT_STAGED_SIZE       4
+
+/*
+ * Keep the micros() of the last edge of every pin and how long its
+ * previous level lasted, see PcInt::getEdgeTime() and getLevelTime().
+ * The stamps are taken in the ISR, also with PCINT_DEFERRED.  Costs 8
+ * bytes of RAM per pin.  Needed by Sodaq_PcInt_timesignal.h.
+ */
+//#define PCINT_TIMESTAMPS
+
+/*
+ * Copy input pins to output pins in the ISR, e.g. to forward RC
+ * receiver pulses to servos, see PcInt::setPassthrough().  Implies
+ * PCINT_TIMESTAMPS, to measure the pulses.
+ */
+//#define PCINT_PASSTHROUGH
+
+/*
+ * Do not use the pin tables of Sodaq_PcInt_pins.h, for a board whose
+ * variant differs from the one the table of its MCU was generated for.
+ * PcInt::attachInterrupt<pin>() is not available then.
+ */
+//#define PCINT_NO_PIN_TABLE
+
+#endif /* SODAQ_PCINT_CONFIG_H_ */
@@ -0,0 +1,1277 @@
+/*
+ * Sodaq_PcInt_impl.h
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ *
+ * This module supplies a set of helper functions to use the
+ * PinChange interrupt in a convenient manner, similar to
+ * the standard Arduino attachInterrupt.  It was created with
+ * inspiration from PcInt, PinChangeInt and PciManager.  The main
+ * goal was to keep it simple and small as possible.
+ *
+ * The handler prototype is void (*)(void).  This makes is identical
+ * to the call backs for Ardiuno's attachInterrupt.
+ *
+ * A simple example of its usage is as follows:
+ *
+ *   #include <PcInt.h>
+ *
+ *   void setup()
+ *   {
+ *     pinMode(A0, INPUT_PULLUP);
+ *     PcInt::attachInterrupt(A0, handleA0);
+ *   }
+ *
+ *   void handlerA0()
+ *   {
+ *     // pin A0 changed, do something
+ *   }
+ *
+ * The user program is responsible to look at the I/O pin and see what
+ * happened.  The original PcInt keeps track of old port values so that
+ * it can see which of the port pins changed.
+ *
+ * The implementation is in this header so that, with PCINT_HEADER_ONLY,
+ * it is compiled in the sketch itself.  Otherwise Sodaq_PcInt.cpp
+ * includes it.
+ */
+
+#ifndef SODAQ_PCINT_IMPL_H_
+#define SODAQ_PCINT_IMPL_H_
+
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <Arduino.h>
+
+#include "Sodaq_PcInt.h"
+
+#if defined(SODAQ_PCINT_ATTACH_H_)
+#error "Include Sodaq_PcInt_attach.h after Sodaq_PcInt_impl.h"
+#endif
+
+#if defined(PCINT_DEFERRED) && defined(PCINT_PENDING_GPIOR) && !defined(PCINT_GROUP_HOOKS) && \
+    !defined(PCINT_PASSTHROUGH) && !defined(PCINT_TIMESTAMPS)
+/*
+ * Marking the group as pending is a single sbi, which changes neither
+ * registers nor SREG.  So the ISR does not need a prologue or epilogue.
+ * Hooks, the passthrough copy and the timestamps run C code in the ISR,
+ * they need one.
+ */
+#define PCINT_ISR_FLAGS         ISR_NAKED
+#define PCINT_ISR_RETURN()      reti()
+#else
+#define PCINT_ISR_FLAGS         ISR_BLOCK
+#define PCINT_ISR_RETURN()
+#endif
+
+#if defined(PCINT_STATIC_HANDLERS)
+/*
+ * The PCINT_HANDLER() entries, in flash.  The linker defines these
+ * symbols for the section.  They are weak, for a program without
+ * handlers.
+ */
+extern const PcInt::StaticHandler __start_pcint_handlers[] __attribute__((__weak__));
+extern const PcInt::StaticHandler __stop_pcint_handlers[] __attribute__((__weak__));
+#endif
+
+PCINT_STATE PcInt::Group PcInt::_groups[PCINT_NUM_GROUPS];
+
+#if defined(PCINT_DEFERRED) && !defined(PCINT_PENDING_GPIOR)
+PCINT_STATE volatile uint8_t PcInt::_pending;
+#endif
+
+#if defined(PCINT_STAGED_CONFIG)
+PCINT_STATE PcInt::StagedChange PcInt::_staged[PCINT_STAGED_SIZE];
+PCINT_STATE uint8_t PcInt::_nrStaged;
+PCINT_STATE uint8_t PcInt::_dispatching;
+#endif
+
+#if defined(PCINT_PROFILING)
+PCINT_STATE uint32_t PcInt::_loadTime;
+PCINT_STATE uint32_t PcInt::_loadStart;
+#endif
+
+#if defined(PCINT_BUDGETS)
+PCINT_STATE void   (*PcInt::_overrunFunc)(uint8_t group, uint8_t nr, uint16_t elapsed);
+#endif
+
+#if defined(PCINT_STATIC_HANDLERS)
+/*
+ * Enable the pin change interrupts of the PCINT_HANDLER() pins
+ *
+ * The current levels of the pins are the reference for the first edge,
+ * so call it after the pinMode() of the pins: the pull-up of
+ * INPUT_PULLUP would otherwise look like a rising edge.
+ */
+void PcInt::begin()
+{
+  uint8_t sreg = SREG;
+  cli();
+  for (const StaticHandler * handler = __start_pcint_handlers; handler < __stop_pcint_handlers; ++handler) {
+    uint8_t group = pgm_read_byte(&handler->group);
+    volatile uint8_t * port = &_SFR_MEM8(pgm_read_word(&handler->port));
+    _groups[group].port = port;
+    _groups[group].last = *port;
+    _SFR_MEM8(pgm_read_byte(&handler->pcmsk)) |= _BV(pgm_read_byte(&handler->pcmskBit));
+    _SFR_MEM8(pgm_read_byte(&handler->pcicr)) |= _BV(pgm_read_byte(&handler->pcie));
+  }
+  SREG = sreg;
+}
+
+/*
+ * Get the handler of a group and port bit
+ *
+ * This function serves just for diagnostic purposes.
+ */
+void (*PcInt::getFunc(uint8_t group, uint8_t nr))(void)
+{
+  for (const StaticHandler * handler = __start_pcint_handlers; handler < __stop_pcint_handlers; ++handler) {
+    if (pgm_read_byte(&handler->group) == group && pgm_read_byte(&handler->nr) == nr) {
+      return (void (*)(void))pgm_read_ptr(&handler->func);
+    }
+  }
+  return 0;
+}
+#else
+#if defined(PCINT_COMPACT_HANDLERS)
+/*
+ * Find the index of a handler in the PROGMEM table, 0 if it is not listed
+ */
+inline PcInt::Slot PcInt::toSlot(void (*func)(void))
+{
+  if (func) {
+    for (uint8_t i = 1; i < _nrHandlers; ++i) {
+      if ((void (*)(void))pgm_read_ptr(&_handlers[i]) == func) {
+        return i;
+      }
+    }
+  }
+  return 0;
+}
+
+inline void (*PcInt::toFunc(Slot slot))(void)
+{
+  return slot ? (void (*)(void))pgm_read_ptr(&_handlers[slot]) : 0;
+}
+#else
+inline PcInt::Slot PcInt::toSlot(void (*func)(void))
+{
+  return func;
+}
+
+inline void (*PcInt::toFunc(Slot slot))(void)
+{
+  return slot;
+}
+#endif
+
+/*
+ * Set the function pointer in the array using the port's pin bit mask
+ */
+static void setFunc(PcInt::Slot funcs[], uint8_t portBitMask, PcInt::Slot func)
+{
+  for (uint8_t i = 0; i < 8; ++i) {
+    if (portBitMask & 1) {
+      funcs[i] = func;
+      break;
+    }
+    portBitMask >>= 1;
+  }
+}
+
+/*
+ * Install the handler of a pin, given its group, its bit in the port and
+ * the PIN register of the port
+ */
+void PcInt::attachPin(uint8_t group, uint8_t portBitMask, volatile uint8_t * port, void (*func)(void))
+{
+  Slot * funcs = groupFuncs(group);
+  if (funcs) {
+    setFunc(funcs, portBitMask, toSlot(func));
+  }
+#if defined(PCINT_TRACK_CHANGES)
+  if (group < PCINT_NUM_GROUPS) {
+    uint8_t sreg = SREG;
+    cli();
+    // Only this pin: a pending edge of another pin must still be seen
+    _groups[group].port = port;
+    _groups[group].last = (_groups[group].last & ~portBitMask) | (*port & portBitMask);
+#if defined(PCINT_TIMESTAMPS) && defined(PCINT_DEFERRED)
+    _groups[group].stamped = (_groups[group].stamped & ~portBitMask) | (*port & portBitMask);
+#endif
+#if defined(PCINT_ATTACH_SHIM)
+    _groups[group].skipRise &= ~portBitMask;
+    _groups[group].skipFall &= ~portBitMask;
+#endif
+    SREG = sreg;
+  }
+#else
+  (void)port;
+#endif
+}
+
+void PcInt::attachInterrupt(uint8_t pin, void (*func)(void))
+{
+#if defined(PCINT_STAGED_CONFIG)
+  if (stage(STAGE_ATTACH, pin, func, CHANGE)) {
+    return;
+  }
+#endif
+  volatile uint8_t * pcicr = digitalPinToPCICR(pin);
+  volatile uint8_t * pcmsk = digitalPinToPCMSK(pin);
+  if (pcicr && pcmsk) {
+    attachPin(digitalPinToPCICRbit(pin), digitalPinToBitMask(pin),
+              portInputRegister(digitalPinToPort(pin)), func);
+    *pcmsk |= _BV(digitalPinToPCMSKbit(pin));
+    *pcicr |= _BV(digitalPinToPCICRbit(pin));
+  }
+}
+
+void PcInt::detachInterrupt(uint8_t pin)
+{
+#if defined(PCINT_STAGED_CONFIG)
+  if (stage(STAGE_DETACH, pin, 0, 0)) {
+    return;
+  }
+#endif
+  volatile uint8_t * pcmsk = digitalPinToPCMSK(pin);
+  if (pcmsk) {
+    *pcmsk &= ~_BV(digitalPinToPCMSKbit(pin));
+    attachPin(digitalPinToPCICRbit(pin), digitalPinToBitMask(pin),
+              portInputRegister(digitalPinToPort(pin)), 0);
+  }
+}
+
+#if defined(PCINT_ATTACH_SHIM)
+void PcInt::attachInterrupt(uint8_t pin, void (*func)(void), uint8_t mode)
+{
+#if defined(PCINT_STAGED_CONFIG)
+  if (stage(STAGE_ATTACH, pin, func, mode)) {
+    return;
+  }
+#endif
+  uint8_t group = digitalPinToPCICRbit(pin);
+  uint8_t portBitMask = digitalPinToBitMask(pin);
+  if (!digitalPinToPCICR(pin) || group >= PCINT_NUM_GROUPS) {
+    return;
+  }
+  // The handler must not see an edge of the wrong kind in between
+  uint8_t sreg = SREG;
+  cli();
+  attachInterrupt(pin, func);
+  if (mode == RISING) {
+    _groups[group].skipFall |= portBitMask;
+  } else if (mode == FALLING || mode == LOW) {
+    _groups[group].skipRise |= portBitMask;
+  }
+  SREG = sreg;
+}
+
+/*
+ * Like digitalPinToInterrupt(), but a pin without an external interrupt
+ * gets PCINT_SHIM_PIN | pin if it has a pin change interrupt
+ */
+int PcInt::toInterrupt(uint8_t pin)
+{
+  int num = digitalPinToInterrupt(pin);
+  if (num != NOT_AN_INTERRUPT) {
+    return num;
+  }
+  return digitalPinToPCICR(pin) ? (PCINT_SHIM_PIN | pin) : NOT_AN_INTERRUPT;
+}
+
+/*
+ * The core's functions are called as (::attachInterrupt), so that the
+ * macros of Sodaq_PcInt_attach.h do not apply to them.
+ */
+void PcInt::attachInterruptNum(uint8_t num, void (*func)(void), int mode)
+{
+  if (num & PCINT_SHIM_PIN) {
+    attachInterrupt(num & ~PCINT_SHIM_PIN, func, mode);
+  } else {
+    (::attachInterrupt)(num, func, mode);
+  }
+}
+
+void PcInt::detachInterruptNum(uint8_t num)
+{
+  if (num & PCINT_SHIM_PIN) {
+    detachInterrupt(num & ~PCINT_SHIM_PIN);
+  } else {
+    (::detachInterrupt)(num);
+  }
+}
+#endif
+#endif
+
+void PcInt::enableInterrupt(uint8_t pin)
+{
+#if defined(PCINT_STAGED_CONFIG)
+  if (stage(STAGE_ENABLE, pin, 0, 0)) {
+    return;
+  }
+#endif
+  volatile uint8_t * pcmsk = digitalPinToPCMSK(pin);
+  if (pcmsk) {
+    *pcmsk |= _BV(digitalPinToPCMSKbit(pin));
+  }
+}
+
+void PcInt::disableInterrupt(uint8_t pin)
+{
+#if defined(PCINT_STAGED_CONFIG)
+  if (stage(STAGE_DISABLE, pin, 0, 0)) {
+    return;
+  }
+#endif
+  volatile uint8_t * pcmsk = digitalPinToPCMSK(pin);
+  if (pcmsk) {
+    *pcmsk &= ~_BV(digitalPinToPCMSKbit(pin));
+  }
+}
+
+#if defined(PCINT_STAGED_CONFIG)
+/*
+ * Queue a change of the configuration while handlers are being called,
+ * so that all handlers of an interrupt see the same configuration.
+ * Returns false if the change must be done now, outside dispatch.
+ *
+ * When the queue is full the queued changes are done first, so the
+ * order stays the one in which they were made.
+ */
+bool PcInt::stage(uint8_t op, uint8_t pin, void (*func)(void), uint8_t mode)
+{
+  bool staged = false;
+  uint8_t sreg = SREG;
+  cli();
+  if (_dispatching) {
+    if (_nrStaged == PCINT_STAGED_SIZE) {
+      // The changes done by commitStaged() must not be queued again
+      uint8_t dispatching = _dispatching;
+      _dispatching = 0;
+      commitStaged();
+      _dispatching = dispatching;
+    }
+    StagedChange & change = _staged[_nrStaged++];
+    change.op = op;
+    change.pin = pin;
+    change.mode = mode;
+    change.func = func;
+    staged = true;
+  }
+  SREG = sreg;
+  return staged;
+}
+
+/*
+ * Do the queued changes, in the order they were made.  Called at the end
+ * of the outermost dispatch.
+ */
+void PcInt::commitStaged()
+{
+  uint8_t sreg = SREG;
+  cli();
+  for (uint8_t i = 0; i < _nrStaged; ++i) {
+    StagedChange & change = _staged[i];
+    switch (change.op) {
+#if !defined(PCINT_STATIC_HANDLERS)
+    case STAGE_ATTACH:
+#if defined(PCINT_ATTACH_SHIM)
+      attachInterrupt(change.pin, change.func, change.mode);
+#else
+      attachInterrupt(change.pin, change.func);
+#endif
+      break;
+    case STAGE_DETACH:
+      detachInterrupt(change.pin);
+      break;
+#endif
+    case STAGE_ENABLE:
+      enableInterrupt(change.pin);
+      break;
+    case STAGE_DISABLE:
+      disableInterrupt(change.pin);
+      break;
+    }
+  }
+  _nrStaged = 0;
+  SREG = sreg;
+}
+#endif
+
+#if !defined(PCINT_STATIC_HANDLERS)
+/*
+ * Get the dispatch table of a group, 0 if there is no such group
+ */
+inline PcInt::Slot * PcInt::groupFuncs(uint8_t group)
+{
+  return group < PCINT_NUM_GROUPS ? _groups[group].funcs : 0;
+}
+
+/*
+ * Get the installed function pointer
+ *
+ * This function serves just for diagnostic purposes.
+ */
+void (*PcInt::getFunc(uint8_t group, uint8_t nr))(void)
+{
+  Slot * funcs = groupFuncs(group);
+  if (nr >= 8 || !funcs) {
+    return 0;
+  }
+  return toFunc(funcs[nr]);
+}
+#endif
+
+#if defined(PCINT_PROFILING)
+/*
+ * Read an atomic copy of a 32 bit counter that is updated by the ISR
+ */
+static uint32_t readCounter(const uint32_t * counter)
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t value = *counter;
+  SREG = sreg;
+  return value;
+}
+
+uint32_t PcInt::getGroupTime(uint8_t group)
+{
+  if (group >= PCINT_NUM_GROUPS) {
+    return 0;
+  }
+  return readCounter(&_groups[group].time);
+}
+
+uint32_t PcInt::getFuncTime(uint8_t group, uint8_t nr)
+{
+  if (group >= PCINT_NUM_GROUPS || nr >= 8) {
+    return 0;
+  }
+  return readCounter(&_groups[group].funcStats[nr].time);
+}
+
+/*
+ * Get a consistent copy of the execution statistics of a handler
+ *
+ * Returns false if group or nr are out of range.
+ */
+bool PcInt::getFuncStats(uint8_t group, uint8_t nr, FuncStats & stats)
+{
+  if (group >= PCINT_NUM_GROUPS || nr >= 8) {
+    return false;
+  }
+  uint8_t sreg = SREG;
+  cli();
+  stats = _groups[group].funcStats[nr];
+  SREG = sreg;
+  return true;
+}
+
+uint16_t PcInt::getFuncAverage(uint8_t group, uint8_t nr)
+{
+  FuncStats stats;
+  if (!getFuncStats(group, nr, stats) || stats.count == 0) {
+    return 0;
+  }
+  return stats.time / stats.count;
+}
+
+uint8_t PcInt::getSlowestFunc(uint8_t group)
+{
+  uint8_t slowest = 0xFF;
+  uint16_t max = 0;
+  FuncStats stats;
+  for (uint8_t nr = 0; nr < 8; ++nr) {
+    if (getFuncStats(group, nr, stats) && stats.count != 0 && (slowest == 0xFF || stats.max > max)) {
+      slowest = nr;
+      max = stats.max;
+    }
+  }
+  return slowest;
+}
+
+/*
+ * Get the percentage of CPU time spent in the PCINT ISRs
+ *
+ * The window is the time since the previous call of getLoad (or
+ * resetProfile).  The measured time starts at the entry of handlePCINTn
+ * and ends at its exit, so the ISR prologue and epilogue are not included.
+ */
+uint8_t PcInt::getLoad()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t busy = _loadTime;
+  _loadTime = 0;
+  SREG = sreg;
+
+  uint32_t now = micros();
+  uint32_t window = now - _loadStart;
+  _loadStart = now;
+  if (window == 0) {
+    return 0;
+  }
+  if (busy >= window) {
+    return 100;
+  }
+  return (uint8_t)((busy * 100) / window);
+}
+
+void PcInt::resetProfile()
+{
+  uint8_t sreg = SREG;
+  cli();
+  for (uint8_t group = 0; group < PCINT_NUM_GROUPS; ++group) {
+    _groups[group].time = 0;
+    for (uint8_t nr = 0; nr < 8; ++nr) {
+      FuncStats & stats = _groups[group].funcStats[nr];
+      stats.time = 0;
+      stats.count = 0;
+      stats.min = 0;
+      stats.max = 0;
+    }
+  }
+  _loadTime = 0;
+  _loadStart = micros();
+  SREG = sreg;
+}
+#endif
+
+#if defined(PCINT_PROFILING)
+/*
+ * Add the execution time of one handler call to its statistics
+ */
+static inline void addSample(PcInt::FuncStats & stats, uint32_t elapsed)
+{
+  uint16_t t = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+  stats.time += elapsed;
+  if (stats.count++ == 0 || t < stats.min) {
+    stats.min = t;
+  }
+  if (t > stats.max) {
+    stats.max = t;
+  }
+}
+#endif
+
+#if defined(PCINT_BUDGETS) || defined(PCINT_TIMESTAMPS)
+/*
+ * Get the index of the lowest bit set in the port's pin bit mask
+ */
+static uint8_t bitNr(uint8_t portBitMask)
+{
+  uint8_t nr = 0;
+  while (nr < 7 && !(portBitMask & 1)) {
+    portBitMask >>= 1;
+    ++nr;
+  }
+  return nr;
+}
+#endif
+
+#if defined(PCINT_BUDGETS)
+void PcInt::setBudget(uint8_t pin, uint16_t budget)
+{
+  if (digitalPinToPCICR(pin)) {
+    uint8_t group = digitalPinToPCICRbit(pin);
+    if (group < PCINT_NUM_GROUPS) {
+      uint8_t sreg = SREG;
+      cli();
+      _groups[group].funcBudget[bitNr(digitalPinToBitMask(pin))] = budget;
+      SREG = sreg;
+    }
+  }
+}
+
+uint16_t PcInt::getOverruns(uint8_t group, uint8_t nr)
+{
+  if (group >= PCINT_NUM_GROUPS || nr >= 8) {
+    return 0;
+  }
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t overruns = _groups[group].funcOverruns[nr];
+  SREG = sreg;
+  return overruns;
+}
+
+void PcInt::clearOverruns()
+{
+  uint8_t sreg = SREG;
+  cli();
+  for (uint8_t group = 0; group < PCINT_NUM_GROUPS; ++group) {
+    for (uint8_t nr = 0; nr < 8; ++nr) {
+      _groups[group].funcOverruns[nr] = 0;
+    }
+  }
+  SREG = sreg;
+}
+
+void PcInt::setOverrunHandler(void (*func)(uint8_t group, uint8_t nr, uint16_t elapsed))
+{
+  uint8_t sreg = SREG;
+  cli();
+  _overrunFunc = func;
+  SREG = sreg;
+}
+#endif
+
+/*
+ * Call one handler, with its timing
+ */
+template <class Func>
+inline void PcInt::callFunc(uint8_t group, uint8_t nr, Func func)
+{
+#if defined(PCINT_TIME_FUNCS)
+  uint32_t funcStart = micros();
+  func();
+  uint32_t funcElapsed = micros() - funcStart;
+  Group & g = _groups[group];
+#if defined(PCINT_PROFILING)
+  addSample(g.funcStats[nr], funcElapsed);
+#endif
+#if defined(PCINT_BUDGETS)
+  uint16_t budget = g.funcBudget[nr];
+  if (budget != 0 && funcElapsed > budget) {
+    if (g.funcOverruns[nr] != 0xFFFF) {
+      ++g.funcOverruns[nr];
+    }
+    if (_overrunFunc) {
+      (*_overrunFunc)(group, nr, funcElapsed > 0xFFFF ? 0xFFFF : funcElapsed);
+    }
+  }
+#endif
+#else
+  (void)group;
+  (void)nr;
+  func();
+#endif
+}
+
+#if defined(PCINT_INLINE_HANDLERS)
+/*
+ * Call the PCINT_INLINE_HANDLER() handlers of a group, false if it has
+ * none
+ */
+inline bool PcInt::dispatchInline(uint8_t group, uint8_t changed)
+{
+  switch (group) {
+  case 0:
+    if (InlineDispatch<0>::any) {
+      InlineDispatch<0>::call(changed);
+      return true;
+    }
+    break;
+#if defined(PCINT1_vect)
+  case 1:
+    if (InlineDispatch<1>::any) {
+      InlineDispatch<1>::call(changed);
+      return true;
+    }
+    break;
+#endif
+#if defined(PCINT2_vect)
+  case 2:
+    if (InlineDispatch<2>::any) {
+      InlineDispatch<2>::call(changed);
+      return true;
+    }
+    break;
+#endif
+#if defined(PCINT3_vect)
+  case 3:
+    if (InlineDispatch<3>::any) {
+      InlineDispatch<3>::call(changed);
+      return true;
+    }
+    break;
+#endif
+  }
+  return false;
+}
+#endif
+
+#if defined(PCINT_TRACK_CHANGES)
+/*
+ * The enabled pins of a group, a constant register for a constant group
+ */
+static inline uint8_t enabledPins(uint8_t group) __attribute__((__always_inline__));
+static inline uint8_t enabledPins(uint8_t group)
+{
+  switch (group) {
+#if defined(PCMSK0)
+  case 0:
+    return PCMSK0;
+#elif defined(PCMSK)
+  case 0:
+    return PCMSK;
+#endif
+#if defined(PCMSK1)
+  case 1:
+    return PCMSK1;
+#endif
+#if defined(PCMSK2)
+  case 2:
+    return PCMSK2;
+#endif
+#if defined(PCMSK3)
+  case 3:
+    return PCMSK3;
+#endif
+  }
+  return 0xFF;
+}
+#endif
+
+/*
+ * Call the handlers of the changed pins of a group
+ *
+ * This is called from the ISR with a constant group, so all the
+ * indexing below is resolved at compile time.  Without change tracking
+ * all handlers of the group are called and changed/state are not used.
+ * With it, only the pins enabled in PCMSK count as changed.
+ */
+inline void PcInt::dispatch(uint8_t group, uint8_t changed, uint8_t state)
+{
+  Group & g = _groups[group];
+#if defined(PCINT_PROFILING)
+  uint32_t start = micros();
+#endif
+#if defined(PCINT_STAGED_CONFIG)
+  ++_dispatching;
+#endif
+#if defined(PCINT_TRACK_CHANGES)
+  g.last = state;
+  // A pin switched off with disableInterrupt() has no calls, also when
+  // another pin of the group interrupts
+  changed &= enabledPins(group);
+#else
+  (void)changed;
+  (void)state;
+#endif
+#if defined(PCINT_TIMESTAMPS) && !defined(PCINT_DEFERRED)
+  // Before the filter; deferred, the ISR already took them
+  stamp(group, changed);
+#endif
+#if defined(PCINT_FILTERS)
+  if (g.filter) {
+    changed = (*g.filter)(group, changed);
+  }
+#endif
+#if defined(PCINT_ATTACH_SHIM)
+  changed &= ~((state & g.skipRise) | (~state & g.skipFall));
+#endif
+#if defined(PCINT_STATIC_HANDLERS)
+  for (const StaticHandler * handler = __start_pcint_handlers; handler < __stop_pcint_handlers; ++handler) {
+    if (pgm_read_byte(&handler->group) != group) {
+      continue;
+    }
+    uint8_t nr = pgm_read_byte(&handler->nr);
+    uint8_t mode = pgm_read_byte(&handler->mode);
+    if (!(changed & _BV(nr)) || (mode != CHANGE && mode != ((state & _BV(nr)) ? RISING : FALLING))) {
+      continue;
+    }
+    callFunc(group, nr, (void (*)(void))pgm_read_ptr(&handler->func));
+  }
+#else
+  Slot * funcs = g.funcs;
+#if defined(PCINT_INLINE_HANDLERS)
+  if (dispatchInline(group, changed)) {
+    funcs = 0;
+  }
+#endif
+  for (uint8_t nr = 0; funcs && nr < 8; ++nr) {
+#if defined(PCINT_TRACK_CHANGES)
+    if (!(changed & _BV(nr))) {
+      continue;
+    }
+#endif
+    if (funcs[nr]) {
+      callFunc(group, nr, toFunc(funcs[nr]));
+    }
+  }
+#endif
+#if defined(PCINT_STAGED_CONFIG)
+  if (--_dispatching == 0 && _nrStaged) {
+    commitStaged();
+  }
+#endif
+#if defined(PCINT_PROFILING)
+  uint32_t elapsed = micros() - start;
+  g.time += elapsed;
+  _loadTime += elapsed;
+#endif
+}
+
+#if defined(PCINT_TIMESTAMPS)
+/*
+ * One timestamp for all the changed pins of an interrupt
+ */
+inline void PcInt::stamp(uint8_t group, uint8_t changed)
+{
+  Group & g = _groups[group];
+  uint32_t now = micros();
+  for (uint8_t nr = 0; changed; ++nr, changed >>= 1) {
+    if (changed & 1) {
+      g.levelTime[nr] = now - g.edgeTime[nr];
+      g.edgeTime[nr] = now;
+    }
+  }
+}
+
+#if defined(PCINT_DEFERRED)
+/*
+ * Stamp the edges in the ISR.  The handlers run later from loop(), and
+ * only see the net change since the previous dispatch.
+ */
+inline void PcInt::stampPort(uint8_t group)
+{
+  Group & g = _groups[group];
+  if (!g.port) {
+    return;
+  }
+  uint8_t state = *g.port;
+  stamp(group, (state ^ g.stamped) & enabledPins(group));
+  g.stamped = state;
+}
+#endif
+#endif
+
+/*
+ * Call the installed handlers of a group, for the current port state
+ */
+inline void PcInt::dispatch(uint8_t group)
+{
+#if defined(PCINT_TRACK_CHANGES)
+  Group & g = _groups[group];
+  uint8_t state = g.port ? *g.port : 0;
+  dispatch(group, state ^ g.last, state);
+#else
+  dispatch(group, 0xFF, 0);
+#endif
+}
+
+/*
+ * Simulate a level change of a pin
+ *
+ * The handlers are called through the same dispatch path as from the
+ * ISR (filters, profiling, budgets), with interrupts disabled.  Group
+ * hooks are not called, they belong to other drivers.  In deferred mode
+ * the handlers are called right away.
+ */
+void PcInt::inject(uint8_t pin, uint8_t level)
+{
+  if (!digitalPinToPCICR(pin)) {
+    return;
+  }
+  uint8_t group = digitalPinToPCICRbit(pin);
+  uint8_t portBitMask = digitalPinToBitMask(pin);
+#if defined(PCINT_TRACK_CHANGES)
+  uint8_t last = group < PCINT_NUM_GROUPS ? _groups[group].last : 0;
+#else
+  uint8_t last = 0;
+#endif
+  uint8_t state = level ? (last | portBitMask) : (last & ~portBitMask);
+  injectMask(group, last ^ state, state);
+}
+
+/*
+ * Simulate an interrupt of a group with the given changed pins and new
+ * port state (bit n is getFunc(group, n))
+ */
+void PcInt::injectMask(uint8_t group, uint8_t changed, uint8_t state)
+{
+  if (group < PCINT_NUM_GROUPS) {
+    uint8_t sreg = SREG;
+    cli();
+#if defined(PCINT_TIMESTAMPS) && defined(PCINT_DEFERRED)
+    // Stamped here like the ISR would
+    stamp(group, changed & enabledPins(group));
+    _groups[group].stamped = (_groups[group].stamped & ~changed) | (state & changed);
+#endif
+    dispatch(group, changed, state);
+    SREG = sreg;
+  }
+}
+
+#if defined(PCINT_TRACK_CHANGES)
+/*
+ * Get the port state of the group as seen by the last dispatch
+ *
+ * Handlers that read this instead of the pin also see injected levels.
+ */
+uint8_t PcInt::getState(uint8_t group)
+{
+  return group < PCINT_NUM_GROUPS ? _groups[group].last : 0;
+}
+#endif
+
+#if defined(PCINT_TIMESTAMPS)
+uint32_t PcInt::getEdgeTime(uint8_t pin)
+{
+  uint8_t group = digitalPinToPCICRbit(pin);
+  if (!digitalPinToPCICR(pin) || group >= PCINT_NUM_GROUPS) {
+    return 0;
+  }
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t time = _groups[group].edgeTime[bitNr(digitalPinToBitMask(pin))];
+  SREG = sreg;
+  return time;
+}
+
+uint32_t PcInt::getLevelTime(uint8_t pin)
+{
+  uint8_t group = digitalPinToPCICRbit(pin);
+  if (!digitalPinToPCICR(pin) || group >= PCINT_NUM_GROUPS) {
+    return 0;
+  }
+  uint8_t sreg = SREG;
+  cli();
+  uint32_t time = _groups[group].levelTime[bitNr(digitalPinToBitMask(pin))];
+  SREG = sreg;
+  return time;
+}
+#endif
+
+#if defined(PCINT_PASSTHROUGH)
+/*
+ * Enable the pin change interrupt of inPin without touching its handler,
+ * and copy it to outPin from then on
+ */
+void PcInt::setPassthrough(uint8_t inPin, uint8_t outPin)
+{
+  volatile uint8_t * pcicr = digitalPinToPCICR(inPin);
+  volatile uint8_t * pcmsk = digitalPinToPCMSK(inPin);
+  uint8_t group = digitalPinToPCICRbit(inPin);
+  uint8_t outPort = digitalPinToPort(outPin);
+  if (!pcicr || !pcmsk || group >= PCINT_NUM_GROUPS || outPort == NOT_A_PORT) {
+    return;
+  }
+  pinMode(outPin, OUTPUT);
+  Group & g = _groups[group];
+  uint8_t nr = bitNr(digitalPinToBitMask(inPin));
+  uint8_t sreg = SREG;
+  cli();
+  g.passOut[nr] = portOutputRegister(outPort);
+  g.passOutMask[nr] = digitalPinToBitMask(outPin);
+  if (!g.port) {
+    g.port = portInputRegister(digitalPinToPort(inPin));
+    g.last = *g.port;
+  }
+  *pcmsk |= _BV(digitalPinToPCMSKbit(inPin));
+  *pcicr |= _BV(group);
+  SREG = sreg;
+  setPassActive(inPin, true);
+}
+
+void PcInt::clearPassthrough(uint8_t inPin)
+{
+  uint8_t group = digitalPinToPCICRbit(inPin);
+  if (!digitalPinToPCICR(inPin) || group >= PCINT_NUM_GROUPS) {
+    return;
+  }
+  setPassActive(inPin, false);
+  _groups[group].passOut[bitNr(digitalPinToBitMask(inPin))] = 0;
+}
+
+void PcInt::overridePassthrough(uint8_t inPin, bool override)
+{
+  setPassActive(inPin, !override);
+}
+
+/*
+ * Start or stop copying a configured pass-through pin.  When it starts
+ * the output gets the current input level, it may have missed edges.
+ */
+void PcInt::setPassActive(uint8_t inPin, bool active)
+{
+  uint8_t group = digitalPinToPCICRbit(inPin);
+  if (!digitalPinToPCICR(inPin) || group >= PCINT_NUM_GROUPS) {
+    return;
+  }
+  Group & g = _groups[group];
+  uint8_t portBitMask = digitalPinToBitMask(inPin);
+  uint8_t nr = bitNr(portBitMask);
+  uint8_t sreg = SREG;
+  cli();
+  if (active && g.passOut[nr]) {
+    g.passMask |= portBitMask;
+    if (*portInputRegister(digitalPinToPort(inPin)) & portBitMask) {
+      *g.passOut[nr] |= g.passOutMask[nr];
+    } else {
+      *g.passOut[nr] &= ~g.passOutMask[nr];
+    }
+  } else {
+    g.passMask &= ~portBitMask;
+  }
+  SREG = sreg;
+}
+
+/*
+ * Copy the pass-through inputs of a group to their outputs.  This is
+ * the first thing the ISR does, so the delay is the interrupt response
+ * plus a few cycles per pin.
+ */
+inline void PcInt::mirror(uint8_t group)
+{
+  Group & g = _groups[group];
+  uint8_t pass = g.passMask;
+  if (!pass) {
+    return;
+  }
+  uint8_t state = *g.port;
+  for (uint8_t nr = 0; pass; ++nr, pass >>= 1, state >>= 1) {
+    if (pass & 1) {
+      if (state & 1) {
+        *g.passOut[nr] |= g.passOutMask[nr];
+      } else {
+        *g.passOut[nr] &= ~g.passOutMask[nr];
+      }
+    }
+  }
+}
+#endif
+
+#if defined(PCINT_FILTERS)
+void PcInt::setFilter(uint8_t group, uint8_t (*filter)(uint8_t group, uint8_t changed))
+{
+  if (group < PCINT_NUM_GROUPS) {
+    uint8_t sreg = SREG;
+    cli();
+    _groups[group].filter = filter;
+    SREG = sreg;
+  }
+}
+#endif
+
+#if defined(PCINT_GROUP_HOOKS)
+void PcInt::attachGroupHook(uint8_t group, GroupHook & hook)
+{
+  if (group >= PCINT_NUM_GROUPS) {
+    return;
+  }
+  detachGroupHook(group, hook);
+  uint8_t sreg = SREG;
+  cli();
+  hook.next = _groups[group].hooks;
+  _groups[group].hooks = &hook;
+  SREG = sreg;
+}
+
+void PcInt::detachGroupHook(uint8_t group, GroupHook & hook)
+{
+  if (group >= PCINT_NUM_GROUPS) {
+    return;
+  }
+  uint8_t sreg = SREG;
+  cli();
+  for (GroupHook ** link = &_groups[group].hooks; *link; link = &(*link)->next) {
+    if (*link == &hook) {
+      *link = hook.next;
+      break;
+    }
+  }
+  SREG = sreg;
+}
+
+inline void PcInt::callHooks(uint8_t group)
+{
+  for (GroupHook * hook = _groups[group].hooks; hook; hook = hook->next) {
+    (*hook->func)();
+  }
+}
+#endif
+
+#if defined(PCINT_DEFERRED)
+inline void PcInt::setPending(uint8_t group)
+{
+#if defined(PCINT_PENDING_GPIOR) && defined(__AVR__)
+  // The naked ISR needs exactly one sbi.  The assembler rejects a
+  // register above I/O address 0x1F (e.g. GPIOR1/GPIOR2), which the
+  // compiler would update with in/ori/out.
+  __asm__ __volatile__ ("sbi %0, %1" :: "I" (_SFR_IO_ADDR(PCINT_PENDING_GPIOR)), "I" (group));
+#elif defined(PCINT_PENDING_GPIOR)
+  PCINT_PENDING_GPIOR |= _BV(group);
+#else
+  _pending |= _BV(group);
+#endif
+}
+
+/*
+ * Test and clear the pending flag of a group
+ */
+inline bool PcInt::takePending(uint8_t group)
+{
+#if defined(PCINT_PENDING_GPIOR)
+  // sbis and cbi, both are atomic
+  if (PCINT_PENDING_GPIOR & _BV(group)) {
+#if defined(__AVR__)
+    __asm__ __volatile__ ("cbi %0, %1" :: "I" (_SFR_IO_ADDR(PCINT_PENDING_GPIOR)), "I" (group));
+#else
+    PCINT_PENDING_GPIOR &= ~_BV(group);
+#endif
+    return true;
+  }
+  return false;
+#else
+  uint8_t sreg = SREG;
+  cli();
+  bool pending = _pending & _BV(group);
+  _pending &= ~_BV(group);
+  SREG = sreg;
+  return pending;
+#endif
+}
+
+void PcInt::dispatchPending()
+{
+#if defined(PCINT0_vect)
+  if (takePending(0)) {
+    dispatch(0);
+  }
+#endif
+#if defined(PCINT1_vect)
+  if (takePending(1)) {
+    dispatch(1);
+  }
+#endif
+#if defined(PCINT2_vect)
+  if (takePending(2)) {
+    dispatch(2);
+  }
+#endif
+#if defined(PCINT3_vect)
+  if (takePending(3)) {
+    dispatch(3);
+  }
+#endif
+}
+#endif
+
+#if defined(PCINT0_vect)
+PCINT_HANDLE_INLINE void PcInt::handlePCINT0()
+{
+#if defined(PCINT_PASSTHROUGH)
+  mirror(0);
+#endif
+#if defined(PCINT_GROUP_HOOKS)
+  callHooks(0);
+#endif
+#if defined(PCINT_DEFERRED)
+#if defined(PCINT_TIMESTAMPS)
+  stampPort(0);
+#endif
+  setPending(0);
+#else
+  dispatch(0);
+#endif
+}
+#if !defined(PCINT_NO_ISR)
+ISR(PCINT0_vect, PCINT_ISR_FLAGS)
+{
+  PcInt::handlePCINT0();
+  PCINT_ISR_RETURN();
+}
+#endif
+#endif
+
+#if defined(PCINT1_vect)
+PCINT_HANDLE_INLINE void PcInt::handlePCINT1()
+{
+#if defined(PCINT_PASSTHROUGH)
+  mirror(1);
+#endif
+#if defined(PCINT_GROUP_HOOKS)
+  callHooks(1);
+#endif
+#if defined(PCINT_DEFERRED)
+#if defined(PCINT_TIMESTAMPS)
+  stampPort(1);
+#endif
+  setPending(1);
+#else
+  dispatch(1);
+#endif
+}
+#if !defined(PCINT_NO_ISR)
+ISR(PCINT1_vect, PCINT_ISR_FLAGS)
+{
+  PcInt::handlePCINT1();
+  PCINT_ISR_RETURN();
+}
+#endif
+#endif
+
+#if defined(PCINT2_vect)
+PCINT_HANDLE_INLINE void PcInt::handlePCINT2()
+{
+#if defined(PCINT_PASSTHROUGH)
+  mirror(2);
+#endif
+#if defined(PCINT_GROUP_HOOKS)
+  callHooks(2);
+#endif
+#if defined(PCINT_DEFERRED)
+#if defined(PCINT_TIMESTAMPS)
+  stampPort(2);
+#endif
+  setPending(2);
+#else
+  dispatch(2);
+#endif
+}
+#if !defined(PCINT_NO_ISR)
+ISR(PCINT2_vect, PCINT_ISR_FLAGS)
+{
+  PcInt::handlePCINT2();
+  PCINT_ISR_RETURN();
+}
+#endif
+#endif
+
+#if defined(PCINT3_vect)
+PCINT_HANDLE_INLINE void PcInt::handlePCINT3()
+{
+#if defined(PCINT_PASSTHROUGH)
+  mirror(3);
+#endif
+#if defined(PCINT_GROUP_HOOKS)
+  callHooks(3);
+#endif
+#if defined(PCINT_DEFERRED)
+#if defined(PCINT_TIMESTAMPS)
+  stampPort(3);
+#endif
+  setPending(3);
+#else
+  dispatch(3);
+#endif
+}
+#if !defined(PCINT_NO_ISR)
+ISR(PCINT3_vect, PCINT_ISR_FLAGS)
+{
+  PcInt::handlePCINT3();
+  PCINT_ISR_RETURN();
+}
+#endif
+#endif
+
+#endif /* SODAQ_PCINT_IMPL_H_ */
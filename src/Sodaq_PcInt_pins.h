@@ -0,0 +1,263 @@
+/*
+ * Sodaq_PcInt_pins.h
+ *
+ * The pin change interrupt pins of the board variants, as constant
+ * tables.  They allow PcInt::attachInterrupt<pin>() to check the pin at
+ * compile time and to set up the interrupt without the lookups in the
+ * PROGMEM tables of pins_arduino.h.
+ *
+ * The tables are generated from the variant's pins_arduino.h with
+ * extras/tools/pcint_pinmap.py: the Arduino standard and mega variants,
+ * the Sodaq Mbili and Mighty-1284P standard variants, and the ATtiny84
+ * and ATtiny85 variants of the attiny core.  Paste the output of the
+ * tool for another variant before the #endif below; a table with a
+ * --guard for a board goes before the table of its MCU.
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ */
+
+#ifndef SODAQ_PCINT_PINS_H_
+#define SODAQ_PCINT_PINS_H_
+
+#include <stdint.h>
+
+#define PCINT_NO_GROUP          0xFF
+
+struct PcIntPin
+{
+  uint8_t group;                // PCINTn_vect, PCINT_NO_GROUP if the pin has no PCINT
+  uint8_t pcie;                 // PCICR bit (PCIEn, 4 or 5 in GIMSK on ATtiny)
+  uint8_t pcmskBit;             // digitalPinToPCMSKbit
+  uint8_t portBitMask;          // digitalPinToBitMask
+  uint8_t pcicr;                // data address of PCICR (GIMSK on ATtiny)
+  uint8_t pcmsk;                // data address of the PCMSK of the group
+  uint16_t port;                // data address of the PIN register
+};
+
+// The number of the lowest bit set in a port bit mask
+constexpr uint8_t pcintBitNr(uint8_t mask)
+{
+  return (mask & 1) || mask == 0 ? 0 : 1 + pcintBitNr(mask >> 1);
+}
+
+#if defined(PCINT_NO_PIN_TABLE)
+/* The variant of the board is not the one of its MCU */
+#elif defined(__AVR_ATmega328P__)
+/* pcint_pinmap.py --mcu atmega328p standard */
+#define PCINT_PIN_TABLE
+static constexpr PcIntPin pcintPins[] = {
+  { 2, 2, 0, 0x01, 0x68, 0x6D, 0x029 },       // 0
+  { 2, 2, 1, 0x02, 0x68, 0x6D, 0x029 },       // 1
+  { 2, 2, 2, 0x04, 0x68, 0x6D, 0x029 },       // 2
+  { 2, 2, 3, 0x08, 0x68, 0x6D, 0x029 },       // 3
+  { 2, 2, 4, 0x10, 0x68, 0x6D, 0x029 },       // 4
+  { 2, 2, 5, 0x20, 0x68, 0x6D, 0x029 },       // 5
+  { 2, 2, 6, 0x40, 0x68, 0x6D, 0x029 },       // 6
+  { 2, 2, 7, 0x80, 0x68, 0x6D, 0x029 },       // 7
+  { 0, 0, 0, 0x01, 0x68, 0x6B, 0x023 },       // 8
+  { 0, 0, 1, 0x02, 0x68, 0x6B, 0x023 },       // 9
+  { 0, 0, 2, 0x04, 0x68, 0x6B, 0x023 },       // 10
+  { 0, 0, 3, 0x08, 0x68, 0x6B, 0x023 },       // 11
+  { 0, 0, 4, 0x10, 0x68, 0x6B, 0x023 },       // 12
+  { 0, 0, 5, 0x20, 0x68, 0x6B, 0x023 },       // 13
+  { 1, 1, 0, 0x01, 0x68, 0x6C, 0x026 },       // 14
+  { 1, 1, 1, 0x02, 0x68, 0x6C, 0x026 },       // 15
+  { 1, 1, 2, 0x04, 0x68, 0x6C, 0x026 },       // 16
+  { 1, 1, 3, 0x08, 0x68, 0x6C, 0x026 },       // 17
+  { 1, 1, 4, 0x10, 0x68, 0x6C, 0x026 },       // 18
+  { 1, 1, 5, 0x20, 0x68, 0x6C, 0x026 },       // 19
+};
+#elif defined(__AVR_ATmega2560__)
+/* pcint_pinmap.py --mcu atmega2560 mega */
+#define PCINT_PIN_TABLE
+static constexpr PcIntPin pcintPins[] = {
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 0
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 1
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 2
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 3
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 4
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 5
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 6
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 7
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 8
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 9
+  { 0, 0, 4, 0x10, 0x68, 0x6B, 0x023 },       // 10
+  { 0, 0, 5, 0x20, 0x68, 0x6B, 0x023 },       // 11
+  { 0, 0, 6, 0x40, 0x68, 0x6B, 0x023 },       // 12
+  { 0, 0, 7, 0x80, 0x68, 0x6B, 0x023 },       // 13
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 14
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 15
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 16
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 17
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 18
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 19
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 20
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 21
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 22
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 23
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 24
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 25
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 26
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 27
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 28
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 29
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 30
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 31
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 32
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 33
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 34
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 35
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 36
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 37
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 38
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 39
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 40
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 41
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 42
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 43
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 44
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 45
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 46
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 47
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 48
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 49
+  { 0, 0, 3, 0x08, 0x68, 0x6B, 0x023 },       // 50
+  { 0, 0, 2, 0x04, 0x68, 0x6B, 0x023 },       // 51
+  { 0, 0, 1, 0x02, 0x68, 0x6B, 0x023 },       // 52
+  { 0, 0, 0, 0x01, 0x68, 0x6B, 0x023 },       // 53
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 54
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 55
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 56
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 57
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 58
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 59
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 60
+  { PCINT_NO_GROUP, 0, 0, 0, 0, 0, 0 },       // 61
+  { 2, 2, 0, 0x01, 0x68, 0x6D, 0x106 },       // 62
+  { 2, 2, 1, 0x02, 0x68, 0x6D, 0x106 },       // 63
+  { 2, 2, 2, 0x04, 0x68, 0x6D, 0x106 },       // 64
+  { 2, 2, 3, 0x08, 0x68, 0x6D, 0x106 },       // 65
+  { 2, 2, 4, 0x10, 0x68, 0x6D, 0x106 },       // 66
+  { 2, 2, 5, 0x20, 0x68, 0x6D, 0x106 },       // 67
+  { 2, 2, 6, 0x40, 0x68, 0x6D, 0x106 },       // 68
+  { 2, 2, 7, 0x80, 0x68, 0x6D, 0x106 },       // 69
+};
+#elif defined(ARDUINO_AVR_SODAQ_MBILI)
+/* pcint_pinmap.py --mcu atmega1284p mbili */
+#define PCINT_PIN_TABLE
+static constexpr PcIntPin pcintPins[] = {
+  { 3, 3, 0, 0x01, 0x68, 0x73, 0x029 },       // 0
+  { 3, 3, 1, 0x02, 0x68, 0x73, 0x029 },       // 1
+  { 3, 3, 2, 0x04, 0x68, 0x73, 0x029 },       // 2
+  { 3, 3, 3, 0x08, 0x68, 0x73, 0x029 },       // 3
+  { 3, 3, 4, 0x10, 0x68, 0x73, 0x029 },       // 4
+  { 3, 3, 5, 0x20, 0x68, 0x73, 0x029 },       // 5
+  { 3, 3, 6, 0x40, 0x68, 0x73, 0x029 },       // 6
+  { 3, 3, 7, 0x80, 0x68, 0x73, 0x029 },       // 7
+  { 1, 1, 0, 0x01, 0x68, 0x6C, 0x023 },       // 8
+  { 1, 1, 1, 0x02, 0x68, 0x6C, 0x023 },       // 9
+  { 1, 1, 2, 0x04, 0x68, 0x6C, 0x023 },       // 10
+  { 1, 1, 3, 0x08, 0x68, 0x6C, 0x023 },       // 11
+  { 1, 1, 4, 0x10, 0x68, 0x6C, 0x023 },       // 12
+  { 1, 1, 5, 0x20, 0x68, 0x6C, 0x023 },       // 13
+  { 1, 1, 6, 0x40, 0x68, 0x6C, 0x023 },       // 14
+  { 1, 1, 7, 0x80, 0x68, 0x6C, 0x023 },       // 15
+  { 2, 2, 0, 0x01, 0x68, 0x6D, 0x026 },       // 16
+  { 2, 2, 1, 0x02, 0x68, 0x6D, 0x026 },       // 17
+  { 2, 2, 2, 0x04, 0x68, 0x6D, 0x026 },       // 18
+  { 2, 2, 3, 0x08, 0x68, 0x6D, 0x026 },       // 19
+  { 2, 2, 4, 0x10, 0x68, 0x6D, 0x026 },       // 20
+  { 2, 2, 5, 0x20, 0x68, 0x6D, 0x026 },       // 21
+  { 2, 2, 6, 0x40, 0x68, 0x6D, 0x026 },       // 22
+  { 2, 2, 7, 0x80, 0x68, 0x6D, 0x026 },       // 23
+  { 0, 0, 0, 0x01, 0x68, 0x6B, 0x020 },       // 24
+  { 0, 0, 1, 0x02, 0x68, 0x6B, 0x020 },       // 25
+  { 0, 0, 2, 0x04, 0x68, 0x6B, 0x020 },       // 26
+  { 0, 0, 3, 0x08, 0x68, 0x6B, 0x020 },       // 27
+  { 0, 0, 4, 0x10, 0x68, 0x6B, 0x020 },       // 28
+  { 0, 0, 5, 0x20, 0x68, 0x6B, 0x020 },       // 29
+  { 0, 0, 6, 0x40, 0x68, 0x6B, 0x020 },       // 30
+  { 0, 0, 7, 0x80, 0x68, 0x6B, 0x020 },       // 31
+};
+#elif defined(__AVR_ATmega1284P__)
+/* pcint_pinmap.py --mcu atmega1284p standard */
+#define PCINT_PIN_TABLE
+static constexpr PcIntPin pcintPins[] = {
+  { 1, 1, 0, 0x01, 0x68, 0x6C, 0x023 },       // 0
+  { 1, 1, 1, 0x02, 0x68, 0x6C, 0x023 },       // 1
+  { 1, 1, 2, 0x04, 0x68, 0x6C, 0x023 },       // 2
+  { 1, 1, 3, 0x08, 0x68, 0x6C, 0x023 },       // 3
+  { 1, 1, 4, 0x10, 0x68, 0x6C, 0x023 },       // 4
+  { 1, 1, 5, 0x20, 0x68, 0x6C, 0x023 },       // 5
+  { 1, 1, 6, 0x40, 0x68, 0x6C, 0x023 },       // 6
+  { 1, 1, 7, 0x80, 0x68, 0x6C, 0x023 },       // 7
+  { 3, 3, 0, 0x01, 0x68, 0x73, 0x029 },       // 8
+  { 3, 3, 1, 0x02, 0x68, 0x73, 0x029 },       // 9
+  { 3, 3, 2, 0x04, 0x68, 0x73, 0x029 },       // 10
+  { 3, 3, 3, 0x08, 0x68, 0x73, 0x029 },       // 11
+  { 3, 3, 4, 0x10, 0x68, 0x73, 0x029 },       // 12
+  { 3, 3, 5, 0x20, 0x68, 0x73, 0x029 },       // 13
+  { 3, 3, 6, 0x40, 0x68, 0x73, 0x029 },       // 14
+  { 3, 3, 7, 0x80, 0x68, 0x73, 0x029 },       // 15
+  { 2, 2, 0, 0x01, 0x68, 0x6D, 0x026 },       // 16
+  { 2, 2, 1, 0x02, 0x68, 0x6D, 0x026 },       // 17
+  { 2, 2, 2, 0x04, 0x68, 0x6D, 0x026 },       // 18
+  { 2, 2, 3, 0x08, 0x68, 0x6D, 0x026 },       // 19
+  { 2, 2, 4, 0x10, 0x68, 0x6D, 0x026 },       // 20
+  { 2, 2, 5, 0x20, 0x68, 0x6D, 0x026 },       // 21
+  { 2, 2, 6, 0x40, 0x68, 0x6D, 0x026 },       // 22
+  { 2, 2, 7, 0x80, 0x68, 0x6D, 0x026 },       // 23
+  { 0, 0, 0, 0x01, 0x68, 0x6B, 0x020 },       // 24
+  { 0, 0, 1, 0x02, 0x68, 0x6B, 0x020 },       // 25
+  { 0, 0, 2, 0x04, 0x68, 0x6B, 0x020 },       // 26
+  { 0, 0, 3, 0x08, 0x68, 0x6B, 0x020 },       // 27
+  { 0, 0, 4, 0x10, 0x68, 0x6B, 0x020 },       // 28
+  { 0, 0, 5, 0x20, 0x68, 0x6B, 0x020 },       // 29
+  { 0, 0, 6, 0x40, 0x68, 0x6B, 0x020 },       // 30
+  { 0, 0, 7, 0x80, 0x68, 0x6B, 0x020 },       // 31
+};
+#elif defined(__AVR_ATtiny84__)
+/* pcint_pinmap.py --mcu attiny84 tiny14 */
+#define PCINT_PIN_TABLE
+static constexpr PcIntPin pcintPins[] = {
+  { 0, 4, 0, 0x01, 0x5B, 0x32, 0x039 },       // 0
+  { 0, 4, 1, 0x02, 0x5B, 0x32, 0x039 },       // 1
+  { 0, 4, 2, 0x04, 0x5B, 0x32, 0x039 },       // 2
+  { 0, 4, 3, 0x08, 0x5B, 0x32, 0x039 },       // 3
+  { 0, 4, 4, 0x10, 0x5B, 0x32, 0x039 },       // 4
+  { 0, 4, 5, 0x20, 0x5B, 0x32, 0x039 },       // 5
+  { 0, 4, 6, 0x40, 0x5B, 0x32, 0x039 },       // 6
+  { 0, 4, 7, 0x80, 0x5B, 0x32, 0x039 },       // 7
+  { 1, 5, 2, 0x04, 0x5B, 0x40, 0x036 },       // 8
+  { 1, 5, 1, 0x02, 0x5B, 0x40, 0x036 },       // 9
+  { 1, 5, 0, 0x01, 0x5B, 0x40, 0x036 },       // 10
+};
+#elif defined(__AVR_ATtiny85__)
+/* pcint_pinmap.py --mcu attiny85 tiny8 */
+#define PCINT_PIN_TABLE
+static constexpr PcIntPin pcintPins[] = {
+  { 0, 5, 0, 0x01, 0x5B, 0x35, 0x036 },       // 0
+  { 0, 5, 1, 0x02, 0x5B, 0x35, 0x036 },       // 1
+  { 0, 5, 2, 0x04, 0x5B, 0x35, 0x036 },       // 2
+  { 0, 5, 3, 0x08, 0x5B, 0x35, 0x036 },       // 3
+  { 0, 5, 4, 0x10, 0x5B, 0x35, 0x036 },       // 4
+  { 0, 5, 5, 0x20, 0x5B, 0x35, 0x036 },       // 5
+};
+#endif
+
+#endif /* SODAQ_PCINT_PINS_H_ */
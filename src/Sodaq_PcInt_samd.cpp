@@ -0,0 +1,196 @@
+/*
+ * Sodaq_PcInt_samd.cpp
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ *
+ * The PcInt API for SAMD21 boards (Sodaq Autonomo, ExpLoRer, SARA).
+ * The pins are handled by the External Interrupt Controller.  Each pin
+ * that can interrupt has an EIC channel (EXTINTn), and the EIC detects
+ * the edge itself, so a handler is only called for the edges it wants.
+ * All pins are one group; getFunc(0, nr) gives the handler of channel nr.
+ *
+ * EIC_Handler() belongs to the WInterrupts.c of the core, so the
+ * handlers are installed as its callbacks with the core's
+ * attachInterrupt().  The library and the core's attachInterrupt() can
+ * then be used in the same sketch, on different channels.
+ *
+ * Two pins that share a channel cannot both be attached; the last one
+ * wins.
+ */
+
+#if defined(ARDUINO_ARCH_SAMD)
+
+#include <Arduino.h>
+
+#include "Sodaq_PcInt.h"
+
+PCINT_STATE void (*PcInt::_channelFuncs[PCINT_EIC_CHANNELS])(void);
+PCINT_STATE uint8_t PcInt::_channelModes[PCINT_EIC_CHANNELS];
+
+/*
+ * Get the EIC channel of a pin, -1 if it has none
+ */
+static int8_t pinToChannel(uint8_t pin)
+{
+  if (pin >= PINS_COUNT) {
+    return -1;
+  }
+  EExt_Interrupts channel = g_APinDescription[pin].ulExtInt;
+  if (channel == NOT_AN_INTERRUPT || channel == EXTERNAL_INT_NMI || channel >= PCINT_EIC_CHANNELS) {
+    return -1;
+  }
+  return channel;
+}
+
+/*
+ * Set the 4 bit SENSE/FILTEN field of a channel
+ */
+static void setSense(uint8_t channel, uint32_t sense)
+{
+  uint8_t pos = (channel % 8) * 4;
+  uint32_t config = EIC->CONFIG[channel / 8].reg;
+  config &= ~((uint32_t)0xF << pos);
+  EIC->CONFIG[channel / 8].reg = config | (sense << pos);
+}
+
+/*
+ * Stop a channel: no interrupt, and no flag for the core's EIC_Handler()
+ * to find when another channel interrupts
+ */
+static void stopChannel(uint8_t pin, uint8_t channel)
+{
+  ::detachInterrupt(pin);
+  setSense(channel, EIC_CONFIG_SENSE0_NONE_Val);
+  EIC->INTFLAG.reg = EIC_INTFLAG_EXTINT(1 << channel);
+}
+
+/*
+ * Start a channel with the core's attachInterrupt().  The core only
+ * writes the SENSE bits, so the FILTEN bit set before stays.
+ */
+static void startChannel(uint8_t pin, uint8_t channel, void (*func)(void), uint8_t mode)
+{
+#if defined(PCINT_EIC_FILTER)
+  setSense(channel, EIC_CONFIG_FILTEN0);
+#else
+  (void)channel;
+#endif
+  ::attachInterrupt(pin, func, mode == RISING || mode == FALLING ? mode : CHANGE);
+}
+
+void PcInt::attachInterrupt(uint8_t pin, void (*func)(void))
+{
+  attachInterrupt(pin, func, CHANGE);
+}
+
+void PcInt::attachInterrupt(uint8_t pin, void (*func)(void), uint8_t mode)
+{
+  int8_t channel = pinToChannel(pin);
+  if (channel < 0) {
+    return;
+  }
+  stopChannel(pin, channel);
+  _channelFuncs[channel] = func;
+  _channelModes[channel] = mode;
+  startChannel(pin, channel, func, mode);
+}
+
+void PcInt::detachInterrupt(uint8_t pin)
+{
+  int8_t channel = pinToChannel(pin);
+  if (channel < 0) {
+    return;
+  }
+  stopChannel(pin, channel);
+  _channelFuncs[channel] = 0;
+}
+
+void PcInt::enableInterrupt(uint8_t pin)
+{
+  int8_t channel = pinToChannel(pin);
+  if (channel >= 0 && _channelFuncs[channel]) {
+    // The channel did not sense while it was disabled
+    startChannel(pin, channel, _channelFuncs[channel], _channelModes[channel]);
+  }
+}
+
+void PcInt::disableInterrupt(uint8_t pin)
+{
+  int8_t channel = pinToChannel(pin);
+  if (channel >= 0 && _channelFuncs[channel]) {
+    stopChannel(pin, channel);
+  }
+}
+
+/*
+ * Get the installed function pointer of an EIC channel
+ *
+ * This function serves just for diagnostic purposes.
+ */
+void (*PcInt::getFunc(uint8_t group, uint8_t nr))(void)
+{
+  if (group != 0 || nr >= PCINT_EIC_CHANNELS) {
+    return 0;
+  }
+  return _channelFuncs[nr];
+}
+
+/*
+ * Run the handler of a pin as if it changed to level.  Like the EIC, a
+ * RISING handler is only called for a high level, a FALLING handler for
+ * a low level.  For testing.
+ */
+void PcInt::inject(uint8_t pin, uint8_t level)
+{
+  int8_t channel = pinToChannel(pin);
+  if (channel < 0) {
+    return;
+  }
+  uint8_t mode = _channelModes[channel];
+  if ((mode == RISING && !level) || (mode == FALLING && level)) {
+    return;
+  }
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  if (_channelFuncs[channel]) {
+    (*_channelFuncs[channel])();
+  }
+  __set_PRIMASK(primask);
+}
+
+/*
+ * Run the handlers of the channels in changed, whatever their mode (bit n
+ * is channel n, only the low 8 channels; use inject() for the others)
+ */
+void PcInt::injectMask(uint8_t group, uint8_t changed, uint8_t state)
+{
+  (void)state;
+  if (group != 0) {
+    return;
+  }
+  uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  for (uint8_t channel = 0; changed; ++channel, changed >>= 1) {
+    if ((changed & 1) && _channelFuncs[channel]) {
+      (*_channelFuncs[channel])();
+    }
+  }
+  __set_PRIMASK(primask);
+}
+
+#endif
@@ -0,0 +1,349 @@
+/*
+ * Sodaq_PcInt_timesignal.cpp
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ *
+ * DCF77: every second but the last of a minute starts with a pulse of
+ * 100 ms (0) or 200 ms (1).  The missing pulse of second 59 marks the
+ * minute, the next pulse is second 0 of the minute that the previous
+ * 59 bits describe.
+ *
+ * WWVB: every second starts with a pulse of 200 ms (0), 500 ms (1) or
+ * 800 ms (marker).  Seconds 9, 19, ..., 59 are markers and so is second
+ * 0, so two markers in a row mark the minute.  A frame describes the
+ * minute in which it is sent.
+ */
+
+#include <Arduino.h>
+
+#include "Sodaq_PcInt.h"
+
+#if defined(PCINT_TIMESTAMPS) && !defined(PCINT_STATIC_HANDLERS) && !defined(PCINT_COMPACT_HANDLERS) && \
+    !defined(ARDUINO_ARCH_SAMD)
+
+#include "Sodaq_PcInt_timesignal.h"
+
+// Pulse and second lengths, in microseconds
+#define DCF77_ZERO_MIN          40000UL
+#define DCF77_ONE_MIN           140000UL
+#define DCF77_ONE_MAX           260000UL
+#define WWVB_ZERO_MIN           100000UL
+#define WWVB_ONE_MIN            350000UL
+#define WWVB_MARKER_MIN         650000UL
+#define WWVB_MARKER_MAX         950000UL
+#define SECOND_MIN              900000UL
+#define SECOND_MAX              1100000UL
+
+PCINT_STATE uint8_t PcIntTimeSignal::_pin;
+PCINT_STATE uint8_t PcIntTimeSignal::_format;
+PCINT_STATE bool PcIntTimeSignal::_inverted;
+PCINT_STATE uint8_t PcIntTimeSignal::_frame[8];
+PCINT_STATE uint8_t PcIntTimeSignal::_nrBits;
+PCINT_STATE bool PcIntTimeSignal::_synced;
+PCINT_STATE bool PcIntTimeSignal::_prevMarker;
+PCINT_STATE uint32_t PcIntTimeSignal::_pulseStart;
+PCINT_STATE uint32_t PcIntTimeSignal::_frameStart;
+PCINT_STATE PcIntTime PcIntTimeSignal::_time;
+PCINT_STATE bool PcIntTimeSignal::_valid;
+PCINT_STATE volatile bool PcIntTimeSignal::_available;
+PCINT_STATE uint16_t PcIntTimeSignal::_errors;
+
+void PcIntTimeSignal::begin(uint8_t pin, Format format, bool inverted)
+{
+  _pin = pin;
+  _format = format;
+  _inverted = inverted;
+  _synced = false;
+  _prevMarker = false;
+  _valid = false;
+  _available = false;
+  _errors = 0;
+  PcInt::attachInterrupt(pin, handleEdge);
+}
+
+void PcIntTimeSignal::end()
+{
+  PcInt::detachInterrupt(_pin);
+}
+
+bool PcIntTimeSignal::available()
+{
+  return _available;
+}
+
+bool PcIntTimeSignal::read(PcIntTime & time)
+{
+  uint8_t sreg = SREG;
+  cli();
+  bool valid = _valid;
+  time = _time;
+  _available = false;
+  SREG = sreg;
+  return valid;
+}
+
+uint16_t PcIntTimeSignal::getErrors()
+{
+  uint8_t sreg = SREG;
+  cli();
+  uint16_t errors = _errors;
+  SREG = sreg;
+  return errors;
+}
+
+/*
+ * The PcInt handler of the pin, called at the start and at the end of
+ * every pulse
+ */
+void PcIntTimeSignal::handleEdge()
+{
+  bool level = PcInt::getState(digitalPinToPCICRbit(_pin)) & digitalPinToBitMask(_pin);
+  if (level != _inverted) {
+    pulseStart(PcInt::getEdgeTime(_pin));
+  } else {
+    pulseEnd(PcInt::getLevelTime(_pin));
+  }
+}
+
+/*
+ * A pulse starts a second, one second after the previous pulse.  For
+ * DCF77 a gap of two seconds is the minute mark.
+ */
+void PcIntTimeSignal::pulseStart(uint32_t edge)
+{
+  uint32_t period = edge - _pulseStart;
+  _pulseStart = edge;
+  if (period >= SECOND_MIN && period <= SECOND_MAX) {
+    return;
+  }
+  if (_format == DCF77 && period >= 2 * SECOND_MIN && period <= 2 * SECOND_MAX) {
+    endFrame(edge);
+    return;
+  }
+  loseSync();
+}
+
+/*
+ * Classify the width of a pulse
+ */
+void PcIntTimeSignal::pulseEnd(uint32_t width)
+{
+  if (_format == DCF77) {
+    if (width >= DCF77_ZERO_MIN && width <= DCF77_ONE_MAX) {
+      addBit(width >= DCF77_ONE_MIN);
+    } else {
+      loseSync();
+    }
+    return;
+  }
+
+  if (width < WWVB_ZERO_MIN || width > WWVB_MARKER_MAX) {
+    loseSync();
+    return;
+  }
+  if (width < WWVB_MARKER_MIN) {
+    _prevMarker = false;
+    // A marker is due at seconds 9, 19, ..., 59
+    if (_nrBits % 10 == 9) {
+      loseSync();
+    } else {
+      addBit(width >= WWVB_ONE_MIN);
+    }
+    return;
+  }
+  if (_prevMarker) {
+    // Second 0, the pulse of the previous marker was second 59
+    _synced = true;
+    _nrBits = 0;
+    _frameStart = _pulseStart;
+  } else if (_nrBits % 10 != 9) {
+    loseSync();
+  }
+  _prevMarker = true;
+  addBit(false);
+  if (_synced && _nrBits == 60) {
+    endFrame(_frameStart);
+  }
+}
+
+/*
+ * Store the bit of the current second
+ */
+void PcIntTimeSignal::addBit(bool value)
+{
+  if (!_synced) {
+    return;
+  }
+  if (_nrBits >= 61) {
+    loseSync();
+    return;
+  }
+  if (value) {
+    _frame[_nrBits >> 3] |= _BV(_nrBits & 7);
+  } else {
+    _frame[_nrBits >> 3] &= ~_BV(_nrBits & 7);
+  }
+  ++_nrBits;
+}
+
+void PcIntTimeSignal::loseSync()
+{
+  if (_synced) {
+    ++_errors;
+  }
+  _synced = false;
+  _prevMarker = false;
+}
+
+/*
+ * A minute is complete.  Decode it, and start the next one.
+ */
+void PcIntTimeSignal::endFrame(uint32_t stamp)
+{
+  if (_synced) {
+    PcIntTime time;
+    bool ok = _format == DCF77 ? decodeDcf77(time) : decodeWwvb(time);
+    if (ok) {
+      time.stamp = stamp;
+      _time = time;
+      _valid = true;
+      _available = true;
+    } else {
+      ++_errors;
+    }
+  }
+  // DCF77 syncs on every minute mark, WWVB on a double marker
+  _synced = _format == DCF77;
+  _nrBits = 0;
+}
+
+bool PcIntTimeSignal::bit(uint8_t nr)
+{
+  return _frame[nr >> 3] & _BV(nr & 7);
+}
+
+/*
+ * The value of count bits, the first one is the least significant
+ */
+uint8_t PcIntTimeSignal::bitsLsb(uint8_t first, uint8_t count)
+{
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    if (bit(first + i)) {
+      value |= _BV(i);
+    }
+  }
+  return value;
+}
+
+/*
+ * The value of count bits, the first one is the most significant
+ */
+uint8_t PcIntTimeSignal::bitsMsb(uint8_t first, uint8_t count)
+{
+  uint8_t value = 0;
+  for (uint8_t i = 0; i < count; ++i) {
+    value = (value << 1) | bit(first + i);
+  }
+  return value;
+}
+
+/*
+ * True if the number of ones in bits first..last is even
+ */
+bool PcIntTimeSignal::parity(uint8_t first, uint8_t last)
+{
+  bool odd = false;
+  for (uint8_t nr = first; nr <= last; ++nr) {
+    odd ^= bit(nr);
+  }
+  return !odd;
+}
+
+bool PcIntTimeSignal::decodeDcf77(PcIntTime & time)
+{
+  // 59 seconds, or 60 with a leap second
+  if (_nrBits != 59 && _nrBits != 60) {
+    return false;
+  }
+  // Second 0 is always 0, second 20 always 1, and one of CEST/CET
+  if (bit(0) || !bit(20) || bit(17) == bit(18)) {
+    return false;
+  }
+  if (!parity(21, 28) || !parity(29, 35) || !parity(36, 58)) {
+    return false;
+  }
+  uint8_t minute = bitsLsb(21, 4);
+  uint8_t hour = bitsLsb(29, 4);
+  uint8_t day = bitsLsb(36, 4);
+  uint8_t month = bitsLsb(45, 4);
+  uint8_t year = bitsLsb(50, 4);
+  if (minute > 9 || hour > 9 || day > 9 || month > 9 || year > 9) {
+    return false;
+  }
+  time.minute = minute + 10 * bitsLsb(25, 3);
+  time.hour = hour + 10 * bitsLsb(33, 2);
+  time.day = day + 10 * bitsLsb(40, 2);
+  time.weekday = bitsLsb(42, 3);
+  time.month = month + 10 * bitsLsb(49, 1);
+  time.year = year + 10 * bitsLsb(54, 4);
+  time.summer = bit(17);
+  return time.minute < 60 && time.hour < 24 && time.day >= 1 && time.day <= 31 &&
+         time.weekday >= 1 && time.month >= 1 && time.month <= 12 && time.year < 100;
+}
+
+bool PcIntTimeSignal::decodeWwvb(PcIntTime & time)
+{
+  static const uint8_t daysInMonth[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+  uint8_t minute = bitsMsb(5, 4);
+  uint8_t hour = bitsMsb(15, 4);
+  uint8_t dayUnits = bitsMsb(30, 4);
+  uint8_t dayTens = bitsMsb(25, 4);
+  uint8_t year = bitsMsb(50, 4);
+  if (minute > 9 || hour > 9 || dayUnits > 9 || dayTens > 9 || year > 9) {
+    return false;
+  }
+  time.minute = minute + 10 * bitsMsb(1, 3);
+  time.hour = hour + 10 * bitsMsb(12, 2);
+  time.year = year + 10 * bitsMsb(45, 4);
+  time.weekday = 0;
+  // DST in effect today
+  time.summer = bit(57) && bit(58);
+
+  bool leap = bit(55);
+  uint16_t dayOfYear = dayUnits + 10 * dayTens + 100 * bitsMsb(22, 2);
+  if (time.minute >= 60 || time.hour >= 24 || time.year >= 100 || dayOfYear < 1 ||
+      dayOfYear > (leap ? 366 : 365)) {
+    return false;
+  }
+  uint8_t month = 0;
+  while (true) {
+    uint8_t days = daysInMonth[month] + (month == 1 && leap);
+    if (dayOfYear <= days) {
+      break;
+    }
+    dayOfYear -= days;
+    ++month;
+  }
+  time.month = month + 1;
+  time.day = dayOfYear;
+  return true;
+}
+
+#endif
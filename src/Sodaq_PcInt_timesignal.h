@@ -0,0 +1,124 @@
+/*
+ * Sodaq_PcInt_timesignal.h
+ *
+ * Copyright (c) 2014 Kees Bakker
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+ * Boston, MA  02111-1307  USA
+ *
+ * A decoder for the DCF77 and WWVB time signals, from the output of a
+ * receiver module on a pin change interrupt pin.  It needs
+ * PCINT_TIMESTAMPS.
+ *
+ * The decoder runs in the PcInt handler of the pin, twice per second:
+ * at the start of a pulse it checks the second, at the end it classifies
+ * the pulse width as a bit.  A complete minute is checked (parity for
+ * DCF77, the position markers for WWVB) and decoded in the handler.
+ * With PCINT_DEFERRED the edges are stamped in the ISR, but loop() must
+ * call PcInt::dispatchPending() more often than every 40 ms, or a whole
+ * pulse goes by without a handler call.
+ *
+ *   PcIntTimeSignal::begin(A0, PcIntTimeSignal::DCF77);
+ *   ...
+ *   PcIntTime time;
+ *   if (PcIntTimeSignal::read(time)) {
+ *     // time.hour, time.minute, ... started at micros() time.stamp
+ *   }
+ */
+
+#ifndef SODAQ_PCINT_TIMESIGNAL_H_
+#define SODAQ_PCINT_TIMESIGNAL_H_
+
+#include <stdint.h>
+
+#include "Sodaq_PcInt.h"
+
+#if !defined(PCINT_TIMESTAMPS)
+#error "PcIntTimeSignal needs PCINT_TIMESTAMPS, see Sodaq_PcInt_config.h"
+#endif
+#if defined(PCINT_STATIC_HANDLERS)
+#error "PcIntTimeSignal cannot be combined with PCINT_STATIC_HANDLERS"
+#endif
+#if defined(PCINT_COMPACT_HANDLERS)
+// Its handler is private, the sketch cannot list it in PCINT_HANDLER_TABLE()
+#error "PcIntTimeSignal cannot be combined with PCINT_COMPACT_HANDLERS"
+#endif
+
+struct PcIntTime
+{
+  uint8_t year;                 // 0..99
+  uint8_t month;                // 1..12
+  uint8_t day;                  // 1..31
+  uint8_t weekday;              // 1 (Monday) .. 7, 0 for WWVB
+  uint8_t hour;                 // 0..23
+  uint8_t minute;               // 0..59
+  bool summer;                  // DCF77: CEST, WWVB: DST in effect
+  uint32_t stamp;               // micros() at the start of this minute
+};
+
+class PcIntTimeSignal
+{
+public:
+  enum Format
+  {
+    DCF77,                      // 100/200 ms pulses, local time
+    WWVB,                       // 200/500/800 ms pulses, UTC
+  };
+
+  // inverted is for receivers whose output is low during a pulse
+  static void begin(uint8_t pin, Format format = DCF77, bool inverted = false);
+  static void end();
+
+  // A decoded minute that was not read yet
+  static bool available();
+  // Get the last decoded minute, false if there is none
+  static bool read(PcIntTime & time);
+
+  // Number of times the decoder lost the signal or rejected a minute
+  static uint16_t getErrors();
+
+private:
+  static void handleEdge();
+  static void pulseStart(uint32_t edge);
+  static void pulseEnd(uint32_t width);
+  static void addBit(bool value);
+  static void loseSync();
+  static void endFrame(uint32_t stamp);
+  static bool decodeDcf77(PcIntTime & time);
+  static bool decodeWwvb(PcIntTime & time);
+  static bool bit(uint8_t nr);
+  static uint8_t bitsLsb(uint8_t first, uint8_t count);
+  static uint8_t bitsMsb(uint8_t first, uint8_t count);
+  static bool parity(uint8_t first, uint8_t last);
+
+  static PCINT_STATE uint8_t _pin;
+  static PCINT_STATE uint8_t _format;
+  static PCINT_STATE bool _inverted;
+
+  // The minute being received, bit n of the frame is second n
+  static PCINT_STATE uint8_t _frame[8];
+  static PCINT_STATE uint8_t _nrBits;
+  static PCINT_STATE bool _synced;
+  static PCINT_STATE bool _prevMarker;
+  static PCINT_STATE uint32_t _pulseStart;
+  static PCINT_STATE uint32_t _frameStart;
+
+  static PCINT_STATE PcIntTime _time;
+  static PCINT_STATE bool _valid;
+  static PCINT_STATE volatile bool _available;
+  static PCINT_STATE uint16_t _errors;
+};
+
+#endif /* SODAQ_PCINT_TIMESIGNAL_H_ */